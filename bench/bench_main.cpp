@@ -0,0 +1,1740 @@
+#include <QApplication>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../gl-ctrls/precise_landing_assist_ctrl.h"
+#include "../gl-ctrls/precise_landing_assist_host.h"
+#include "../gl-ctrls/viewport_transform.h"
+#include "../gl-ctrls/target_grid.h"
+#include "../gl-ctrls/rim_clusters.h"
+#include "../gl-ctrls/json_selective_extractor.h"
+#include "../gl-ctrls/geodesy.h"
+
+
+static const double PI = 3.1415926;
+
+static const int warmup_frames = 30;
+static const int bench_frames = 300;
+static const int card_counts[] = {1, 10, 100};
+static const int profile_card_count = 40;
+
+// ellipses of the ctrl in gl units, the range circle, its inner ring and tgt, tessellated for square viewports
+static const float ellipse_radii[] = {0.6f, 0.3f, 0.03f};
+static const int ellipse_viewport_px[] = {200, 1080};
+static const double ellipse_max_chord_error_px = 0.25;
+
+// the old 18 sample surface, then the analytic anti-aliasing
+static const int msaa_samples[] = {18, 0};
+
+// a pixel differs if any channel differs by more than the threshold,
+// the text of the two backends is rasterized differently, so a few pixels always differ
+static const int parity_channel_threshold = 48;
+static const double parity_max_diff_percent = 2.0;
+
+// pixel, largest error of gl -> pixel -> gl -> pixel
+static const double transform_max_error_px = 1e-3;
+
+// picking over a large fleet in a 400 px ctrl, the pick radius and the cells of the ctrl
+static const int pick_target_count = 10000;
+static const int pick_query_count = 100000;
+static const double pick_radius_px = 10;
+static const double pick_cell_px = 20;
+
+// fleets beyond the radius of the ctrl, clustered on the rim
+static const int rim_target_counts[] = {100, 1000, 10000};
+static const double rim_target_distance = 5000;
+
+// fleets inside the radius, built on the gui thread or on the worker pool
+static const int worker_target_counts[] = {100, 1000, 10000};
+
+// threads publishing to one ctrl while the gui thread reads and draws
+static const int seqlock_producer_count = 4;
+static const int seqlock_reads = 200000;
+
+// state messages with a large payload, parsed for the four fields a card subscribes
+static const int json_message_count = 200;
+static const int json_reps = 10;
+static const int json_battery_cells = 512;
+static const int json_status_items = 96;
+
+// Flinders Peak to Buninyong, the worked example of the inverse formula of Vincenty
+static const double flinders_lon = 144 + 25 / 60.0 + 29.52440 / 3600;
+static const double flinders_lat = -(37 + 57 / 60.0 + 3.72030 / 3600);
+static const double buninyong_lon = 143 + 55 / 60.0 + 35.38390 / 3600;
+static const double buninyong_lat = -(37 + 39 / 60.0 + 10.15610 / 3600);
+static const double flinders_buninyong_m = 54972.271;
+static const double flinders_buninyong_deg = 306.868159;
+
+// a uav some 600 m from its platform, the spherical methods are checked against Vincenty
+static const double platform_lon = 113.95;
+static const double platform_lat = 22.53;
+static const double near_uav_lon = 113.9545;
+static const double near_uav_lat = 22.5338;
+
+// the bench PI is too coarse for the reference bearing
+static const double rad_2_deg = 180 / 3.14159265358979323846;
+
+static const int geodesy_point_count = 10000;
+static const int geodesy_reps = 20;
+
+// the batch call against one call per point, the sse2 polynomials differ from libm in the last bits only
+static const double geodesy_batch_max_m = 1e-6;
+static const double geodesy_batch_max_deg = 1e-7;
+
+// gps noise of a hovering or slowly approaching uav
+static const double noise_m = 0.02;
+static const double noise_rad = 0.002;
+
+
+// allocations of the gui thread while counting, the render threads of the driver are left out
+static thread_local bool count_allocations = false;
+static qint64 allocation_count = 0;
+
+static inline void count_allocation()
+{
+    if (count_allocations) ++allocation_count;
+}
+
+#if defined(__GLIBC__)
+// Qt containers allocate with malloc, not with operator new, so malloc itself is counted
+extern "C" void *__libc_malloc(size_t n);
+extern "C" void *__libc_calloc(size_t n, size_t sz);
+extern "C" void *__libc_realloc(void *p, size_t n);
+
+extern "C" void *malloc(size_t n)
+{
+    count_allocation();
+    return __libc_malloc(n);
+}
+
+extern "C" void *calloc(size_t n, size_t sz)
+{
+    count_allocation();
+    return __libc_calloc(n, sz);
+}
+
+extern "C" void *realloc(void *p, size_t n)
+{
+    count_allocation();
+    return __libc_realloc(p, n);
+}
+#else
+// only operator new can be counted portably
+void *operator new(std::size_t n)
+{
+    count_allocation();
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n)
+{
+    count_allocation();
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+#endif
+
+
+/**
+ * @brief percentile of sorted samples
+ */
+static double percentile(const QVector<double> &vecSorted, double p)
+{
+    if (vecSorted.isEmpty()) return 0;
+
+    int idx = static_cast<int>(p * (vecSorted.size() - 1) + 0.5);
+    return vecSorted.at(idx);
+}
+
+static double mean(const QVector<double> &vec)
+{
+    double sum = 0;
+    for (auto v : vec) sum += v;
+
+    return (vec.isEmpty() ? 0 : sum / vec.size());
+}
+
+/**
+ * @brief scripted telemetry, every card flies its own approach
+ */
+static PreciseLandingState script_state(int card, int frame)
+{
+    double dis = 600 + card * 3 - frame * 1.23;
+    double direct = 60 + card * 7 + frame * 0.5;
+    double angle = 30 - frame * 0.5;
+
+    return PreciseLandingState(dis < 0 ? 0 : dis, direct * PI / 180, angle * PI / 180);
+}
+
+/**
+ * @brief gps noise in [-1, 1], the same for the same card, frame and channel
+ */
+static double noise(int card, int frame, int channel)
+{
+    quint32 h = static_cast<quint32>(card) * 73856093u ^ static_cast<quint32>(frame) * 19349663u
+            ^ static_cast<quint32>(channel) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+
+    return (h & 0xffff) / 32767.5 - 1;
+}
+
+/**
+ * @brief the scripted approach ten times slower, with centimeter noise on the position and a little on the heading
+ */
+static PreciseLandingState noisy_state(int card, int frame)
+{
+    auto st = script_state(card, frame / 10);
+    st.distance = qMax(0.0, st.distance + noise(card, frame, 0) * noise_m);
+    st.direction += noise(card, frame, 1) * noise_m / qMax(st.distance, 1.0);
+    st.uav_angle += noise(card, frame, 2) * noise_rad;
+
+    return st;
+}
+
+static void run(int cardCount, int samples)
+{
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->set_msaa_samples(samples);
+        ctrl->resize(200, 200);
+        vecCtrls.push_back(ctrl);
+    }
+
+    QVector<double> vecCpuUs;
+    QVector<double> vecDrawCalls;
+    qint64 gpuBytes = 0;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        qint64 cpuNs = 0;
+        int drawCalls = 0;
+
+        for (int i = 0; i < cardCount; ++i)
+        {
+            auto ctrl = vecCtrls.at(i);
+
+            QElapsedTimer tm;
+            tm.start();
+            ctrl->publish_state(script_state(i, f));
+            ctrl->update_ui();
+            cpuNs += tm.nsecsElapsed();
+
+            // renders offscreen, the read back is not part of the frame stats
+            ctrl->grabFramebuffer();
+
+            auto stats = ctrl->last_frame_stats();
+            cpuNs += stats.cpu_ns;
+            drawCalls += stats.draw_calls;
+            if (i == 0) gpuBytes = stats.gpu_bytes;
+        }
+
+        if (f < warmup_frames) continue;
+
+        vecCpuUs.push_back(cpuNs / 1000.0);
+        vecDrawCalls.push_back(drawCalls);
+    }
+
+    std::sort(vecCpuUs.begin(), vecCpuUs.end());
+
+    printf("%6d %8d %10.1f %10.1f %10.1f %10.1f %10.1f %12.0f %14.1f\n",
+           cardCount, samples, mean(vecCpuUs),
+           percentile(vecCpuUs, 0.5), percentile(vecCpuUs, 0.9), percentile(vecCpuUs, 0.99), vecCpuUs.last(),
+           vecDrawCalls.isEmpty() ? 0.0 : vecDrawCalls.last(), gpuBytes / 1024.0);
+
+    qDeleteAll(vecCtrls);
+}
+
+/**
+ * @brief pixels of two images of one size that differ by more than the threshold in any channel
+ */
+static int differing_pixels(const QImage &img1, const QImage &img2)
+{
+    const QImage a = img1.convertToFormat(QImage::Format_ARGB32);
+    const QImage b = img2.convertToFormat(QImage::Format_ARGB32);
+
+    int diff = 0;
+    for (int y = 0; y < a.height(); ++y)
+    {
+        auto rowA = reinterpret_cast<const QRgb *>(a.constScanLine(y));
+        auto rowB = reinterpret_cast<const QRgb *>(b.constScanLine(y));
+
+        for (int x = 0; x < a.width(); ++x)
+        {
+            const int d = qMax(qMax(qAbs(qRed(rowA[x]) - qRed(rowB[x])),
+                                    qAbs(qGreen(rowA[x]) - qGreen(rowB[x]))),
+                               qAbs(qBlue(rowA[x]) - qBlue(rowB[x])));
+            if (d > parity_channel_threshold) ++diff;
+        }
+    }
+
+    return diff;
+}
+
+/**
+ * @brief the same frame drawn into an image by each backend, gl includes the read back
+ */
+static void run_backends(int cardCount)
+{
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->resize(200, 200);
+        vecCtrls.push_back(ctrl);
+    }
+
+    QVector<double> vecGlUs;
+    QVector<double> vecRasterUs;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        qint64 glNs = 0;
+        qint64 rasterNs = 0;
+
+        for (int i = 0; i < cardCount; ++i)
+        {
+            auto ctrl = vecCtrls.at(i);
+            ctrl->publish_state(script_state(i, f));
+            ctrl->update_ui();
+
+            QElapsedTimer tm;
+            tm.start();
+            ctrl->grabFramebuffer();
+            glNs += tm.nsecsElapsed();
+
+            tm.restart();
+            ctrl->render_image(ctrl->size());
+            rasterNs += tm.nsecsElapsed();
+        }
+
+        if (f < warmup_frames) continue;
+
+        vecGlUs.push_back(glNs / 1000.0);
+        vecRasterUs.push_back(rasterNs / 1000.0);
+    }
+
+    std::sort(vecGlUs.begin(), vecGlUs.end());
+    std::sort(vecRasterUs.begin(), vecRasterUs.end());
+
+    printf("%6d %10.1f %10.1f %10.1f %10.1f\n", cardCount,
+           mean(vecGlUs), percentile(vecGlUs, 0.99), mean(vecRasterUs), percentile(vecRasterUs, 0.99));
+
+    qDeleteAll(vecCtrls);
+}
+
+/**
+ * @brief compare the frames of both backends over the scripted approach
+ * @return the largest percentage of differing pixels of a frame
+ */
+static double check_parity()
+{
+    PreciseLandingAssistCtrl ctrl;
+    ctrl.resize(200, 200);
+
+    // both are time dependent, which the two renders would not share
+    ctrl.set_dead_reckoning(false);
+    ctrl.set_trail(false);
+
+    double worst = 0;
+    for (int f = 0; f < bench_frames; f += 10)
+    {
+        ctrl.publish_state(script_state(0, f));
+        ctrl.update_ui();
+
+        const QImage imgGl = ctrl.grabFramebuffer().convertToFormat(QImage::Format_ARGB32);
+        const QImage imgRaster = ctrl.render_image(imgGl.size()).convertToFormat(QImage::Format_ARGB32);
+
+        const int diff = differing_pixels(imgGl, imgRaster);
+        worst = qMax(worst, 100.0 * diff / (imgGl.width() * imgGl.height()));
+    }
+
+    return worst;
+}
+
+/**
+ * @brief every card in a sub-viewport of one host, one context and one render for all of them
+ */
+static void run_hosted(int cardCount)
+{
+    static const int card_size = 200;
+
+    const int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(cardCount))));
+    const int rows = (cardCount + cols - 1) / cols;
+
+    auto host = new PreciseLandingAssistHost();
+    host->resize(cols * card_size, rows * card_size);
+
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto area = new QWidget(host);
+        area->setGeometry(i % cols * card_size, i / cols * card_size, card_size, card_size);
+
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->resize(card_size, card_size);
+        host->add_ctrl(ctrl, area);
+        vecCtrls.push_back(ctrl);
+    }
+
+    QVector<double> vecCpuUs;
+    int drawCalls = 0;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        QElapsedTimer tm;
+        tm.start();
+
+        for (int i = 0; i < cardCount; ++i)
+        {
+            vecCtrls.at(i)->publish_state(script_state(i, f));
+            vecCtrls.at(i)->update_ui();
+        }
+        qint64 cpuNs = tm.nsecsElapsed();
+
+        host->grabFramebuffer();
+        cpuNs += host->last_frame_stats().cpu_ns;
+        drawCalls = host->last_frame_stats().draw_calls;
+
+        if (f >= warmup_frames) vecCpuUs.push_back(cpuNs / 1000.0);
+    }
+
+    std::sort(vecCpuUs.begin(), vecCpuUs.end());
+
+    printf("%6d %10.1f %10.1f %10.1f %12d\n", cardCount,
+           mean(vecCpuUs), percentile(vecCpuUs, 0.5), percentile(vecCpuUs, 0.99), drawCalls);
+
+    qDeleteAll(vecCtrls);
+    delete host;
+}
+
+/**
+ * @brief a hovering uav, the same telemetry every frame, a frame is only rendered if the ctrl asks for it
+ */
+static void run_stationary(int cardCount, bool elision)
+{
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->resize(200, 200);
+        ctrl->set_frame_elision(elision);
+        ctrl->set_update_filter(false);
+        vecCtrls.push_back(ctrl);
+    }
+
+    QVector<double> vecUs;
+    qint64 painted = 0;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        QElapsedTimer tm;
+        tm.start();
+
+        for (int i = 0; i < cardCount; ++i)
+        {
+            auto ctrl = vecCtrls.at(i);
+            const qint64 elided = ctrl->elided_frames();
+
+            ctrl->publish_state(script_state(i, 0));
+            ctrl->update_ui();
+            if (ctrl->elided_frames() != elided) continue;
+
+            ctrl->grabFramebuffer();
+            if (f >= warmup_frames) ++painted;
+        }
+
+        if (f >= warmup_frames) vecUs.push_back(tm.nsecsElapsed() / 1000.0);
+    }
+
+    std::sort(vecUs.begin(), vecUs.end());
+
+    printf("%6d %8s %10.1f %10.1f %10lld\n", cardCount, elision ? "on" : "off",
+           mean(vecUs), percentile(vecUs, 0.99), painted);
+
+    qDeleteAll(vecCtrls);
+}
+
+/**
+ * @brief a slow approach under gps noise, a frame is only rendered if the update filter lets the sample through
+ */
+static void run_noisy(int cardCount, bool filter)
+{
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->resize(200, 200);
+        ctrl->set_update_filter(filter);
+        vecCtrls.push_back(ctrl);
+    }
+
+    QVector<double> vecUs;
+    qint64 painted = 0;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        QElapsedTimer tm;
+        tm.start();
+
+        for (int i = 0; i < cardCount; ++i)
+        {
+            auto ctrl = vecCtrls.at(i);
+            const qint64 skipped = ctrl->suppressed_updates() + ctrl->elided_frames();
+
+            ctrl->publish_state(noisy_state(i, f));
+            ctrl->update_ui();
+            if (ctrl->suppressed_updates() + ctrl->elided_frames() != skipped) continue;
+
+            ctrl->grabFramebuffer();
+            if (f >= warmup_frames) ++painted;
+        }
+
+        if (f >= warmup_frames) vecUs.push_back(tm.nsecsElapsed() / 1000.0);
+    }
+
+    std::sort(vecUs.begin(), vecUs.end());
+
+    printf("%6d %8s %10.1f %10.1f %10lld\n", cardCount, filter ? "on" : "off",
+           mean(vecUs), percentile(vecUs, 0.99), painted);
+
+    qDeleteAll(vecCtrls);
+}
+
+/**
+ * @brief the fleet of the worker benchmarks, inside the radius, one target in a hundred labelled
+ */
+static void set_worker_fleet(PreciseLandingAssistCtrl &ctrl, int targetCount, int frame)
+{
+    for (int id = frame % 10; id < targetCount; id += 10)
+    {
+        ctrl.set_target(id, PreciseLandingState((noise(id, frame, 5) + 1) * 240, noise(id, frame, 6) * PI,
+                                                noise(id, frame, 7) * PI));
+        if (frame == 0 && id % 100 == 0) ctrl.set_target_labelled(id, true);
+    }
+}
+
+// the state without the queued `update_ui` of `publish_state`
+static void set_state(PreciseLandingAssistCtrl &ctrl, const PreciseLandingState &st)
+{
+    ctrl.set_distance(st.distance);
+    ctrl.set_direction(st.direction);
+    ctrl.set_uav_angle(st.uav_angle);
+}
+
+/**
+ * @brief a fleet beyond the radius, a tenth of it turns every frame,
+ * the draw time of the targets follows the bearing bins, not the fleet
+ */
+static void run_rim_targets(int targetCount)
+{
+    PreciseLandingAssistCtrl ctrl;
+    ctrl.resize(200, 200);
+    ctrl.set_profiling(true);
+
+    for (int id = 0; id < targetCount; ++id)
+    {
+        ctrl.set_target(id, PreciseLandingState(rim_target_distance, noise(id, 0, 6) * PI, 0));
+    }
+
+    QVector<double> vecUs;
+    for (int f = 0; f < warmup_frames + FrameProfiler::window_size; ++f)
+    {
+        QElapsedTimer tm;
+        tm.start();
+
+        for (int id = f % 10; id < targetCount; id += 10)
+        {
+            ctrl.set_target(id, PreciseLandingState(rim_target_distance, noise(id, f, 6) * PI, 0));
+        }
+
+        ctrl.publish_state(script_state(0, f));
+        ctrl.update_ui();
+        ctrl.grabFramebuffer();
+
+        if (f >= warmup_frames) vecUs.push_back(tm.nsecsElapsed() / 1000.0);
+    }
+
+    std::sort(vecUs.begin(), vecUs.end());
+
+    const auto &profiler = ctrl.profiler();
+    printf("%8d %10.1f %10.1f %12.1f %12.1f\n", targetCount, mean(vecUs), percentile(vecUs, 0.99),
+           profiler.cpu_percentile(FrameProfiler::StageTargets, 0.5),
+           profiler.cpu_percentile(FrameProfiler::StageTargets, 0.99));
+}
+
+/**
+ * @brief targets moving in and out of range and around the rim, the incremental bins are compared
+ * with counting all targets again, a bin of one target must point at its bearing
+ * @return the bins that differ
+ */
+static int check_rim_clusters()
+{
+    static const int target_count = 5000;
+    static const int bin_count = 47;
+    static const int frames = 50;
+    static const double two_pi = 2 * 3.14159265358979323846;
+
+    RimClusters clusters;
+    clusters.set_bin_count(bin_count);
+
+    QVector<double> vecDirections(target_count);
+    QVector<bool> vecOutside(target_count);
+
+    int wrong = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        for (int id = 0; id < target_count; ++id)
+        {
+            if ((id + f) % 3 != 0 && f > 0) continue;
+
+            // a few full turns either way
+            vecDirections[id] = noise(id, f, 6) * 3 * PI;
+            vecOutside[id] = (noise(id, f, 7) > -0.5);
+            clusters.update(id, vecDirections.at(id), vecOutside.at(id));
+        }
+
+        // a few leave the fleet
+        if (f == frames / 2)
+        {
+            for (int id = 0; id < target_count; id += 7)
+            {
+                clusters.remove(id);
+                vecOutside[id] = false;
+            }
+        }
+
+        QVector<int> vecCounts(bin_count, 0);
+        QVector<double> vecLast(bin_count, 0);
+        for (int id = 0; id < target_count; ++id)
+        {
+            if (!vecOutside.at(id)) continue;
+
+            double a = std::fmod(vecDirections.at(id), two_pi);
+            if (a < 0) a += two_pi;
+            const int bin = qMin(static_cast<int>(a / two_pi * bin_count), bin_count - 1);
+            ++vecCounts[bin];
+            vecLast[bin] = vecDirections.at(id);
+        }
+
+        for (int bin = 0; bin < bin_count; ++bin)
+        {
+            if (clusters.count(bin) != vecCounts.at(bin))
+            {
+                ++wrong;
+                continue;
+            }
+
+            if (vecCounts.at(bin) != 1) continue;
+
+            const double d = clusters.direction(bin) - vecLast.at(bin);
+            if (std::fabs(std::sin(d)) > 1e-6 || std::cos(d) < 0) ++wrong;
+        }
+    }
+
+    printf("\nrim clusters: %d of %d bins differ from a full count over %d frames\n", wrong, bin_count * frames, frames);
+
+    return wrong;
+}
+
+/**
+ * @brief a fleet half beyond the radius, only the targets inside are picked one by one,
+ * every chevron is picked as its bin, a hovered bin or a bin of a labelled target gets one label
+ * @return the picks and labels that are wrong
+ */
+static int check_rim_picking()
+{
+    static const int target_count = 2000;
+    static const double radius = 500;
+
+    PreciseLandingAssistCtrl ctrl;
+    ctrl.resize(200, 200);
+    ctrl.set_update_filter(false);
+    ctrl.set_radius(radius);
+    ctrl.grabFramebuffer();
+
+    int insideCount = 0;
+    int outsideId = -1;
+    for (int id = 0; id < target_count; ++id)
+    {
+        const double distance = (noise(id, 0, 5) + 1) * radius;
+        ctrl.set_target(id, PreciseLandingState(distance, noise(id, 0, 6) * PI, 0));
+
+        if (distance < radius) ++insideCount;
+        else if (outsideId < 0) outsideId = id;
+    }
+
+    set_state(ctrl, script_state(0, 0));
+    ctrl.update_ui();
+
+    const FramePacket &frame = ctrl.frame();
+
+    int wrong = qAbs(frame.target_ids.size() - insideCount);
+    for (int i = 0; i < frame.rim_bins.size(); ++i)
+    {
+        if (ctrl.rim_bin_at(frame.rim_pixels.at(i).toPoint()) != frame.rim_bins.at(i)) ++wrong;
+    }
+
+    if (!frame.target_labels.isEmpty() || frame.rim_bins.isEmpty()) ++wrong;
+
+    ctrl.set_hovered_rim_bin(frame.rim_bins.first());
+    if (frame.target_labels.size() != 1 || !frame.target_labels.first().text.startsWith('>')) ++wrong;
+
+    // the bin of a labelled target beyond the radius, hovered or not, is labelled once
+    ctrl.set_target_labelled(outsideId, true);
+    ctrl.update_ui();
+    const int labels = frame.target_labels.size();
+    if (labels < 1 || labels > 2) ++wrong;
+
+    ctrl.set_hovered_rim_bin(-1);
+    if (frame.target_labels.size() != 1) ++wrong;
+
+    printf("\nrim picking: %d targets inside, %d chevrons, %d wrong picks or labels\n",
+           frame.target_ids.size(), frame.rim_bins.size(), wrong);
+
+    return wrong;
+}
+
+// the gui thread waits for the packet, then takes it, returns the ns of taking it
+static qint64 take_worker_frame(PreciseLandingAssistCtrl &ctrl, qint64 built)
+{
+    while (ctrl.built_frames() == built)
+    {
+        QThread::yieldCurrentThread();
+    }
+
+    QElapsedTimer tm;
+    tm.start();
+    QCoreApplication::processEvents();
+    return tm.nsecsElapsed();
+}
+
+/**
+ * @brief gui thread time per frame of a moving fleet, the frame built by `update_ui` itself or by the worker pool,
+ * the wait for the worker is not counted
+ */
+static void run_geometry_worker(int targetCount, bool worker)
+{
+    PreciseLandingAssistCtrl ctrl;
+    ctrl.resize(200, 200);
+    ctrl.set_update_filter(false);
+    ctrl.set_frame_elision(false);
+    ctrl.set_geometry_worker(worker);
+
+    QVector<double> vecUpdateUs;
+    QVector<double> vecGuiUs;
+
+    for (int f = 0; f < warmup_frames + bench_frames; ++f)
+    {
+        set_worker_fleet(ctrl, targetCount, f);
+        set_state(ctrl, script_state(0, f));
+
+        const qint64 built = ctrl.built_frames();
+
+        QElapsedTimer tm;
+        tm.start();
+        ctrl.update_ui();
+        const qint64 updateNs = tm.nsecsElapsed();
+
+        const qint64 takeNs = (worker ? take_worker_frame(ctrl, built) : 0);
+
+        tm.restart();
+        ctrl.grabFramebuffer();
+        const qint64 paintNs = tm.nsecsElapsed();
+
+        if (f < warmup_frames) continue;
+
+        vecUpdateUs.push_back(updateNs / 1000.0);
+        vecGuiUs.push_back((updateNs + takeNs + paintNs) / 1000.0);
+    }
+
+    std::sort(vecUpdateUs.begin(), vecUpdateUs.end());
+    std::sort(vecGuiUs.begin(), vecGuiUs.end());
+
+    printf("%8d %8s %10.1f %10.1f %10.1f %10.1f\n", targetCount, worker ? "on" : "off",
+           mean(vecUpdateUs), percentile(vecUpdateUs, 0.99), mean(vecGuiUs), percentile(vecGuiUs, 0.99));
+}
+
+/**
+ * @brief a ctrl building on the gui thread and one building on the worker pool are fed the same frames,
+ * the frames they draw must be the same
+ * @return the frames that differ
+ */
+static int check_geometry_worker()
+{
+    static const int target_count = 500;
+    static const int frames = 40;
+
+    PreciseLandingAssistCtrl ctrlGui;
+    PreciseLandingAssistCtrl ctrlWorker;
+    ctrlWorker.set_geometry_worker(true);
+
+    int wrong = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        const auto st = script_state(0, f);
+        for (auto ctrl : {&ctrlGui, &ctrlWorker})
+        {
+            set_worker_fleet(*ctrl, target_count, f);
+            set_state(*ctrl, st);
+            if (f == frames / 2) ctrl->zoom(4);
+        }
+
+        ctrlGui.update_ui();
+
+        const qint64 built = ctrlWorker.built_frames();
+        ctrlWorker.update_ui();
+        take_worker_frame(ctrlWorker, built);
+
+        if (ctrlGui.render_image(QSize(200, 200)) != ctrlWorker.render_image(QSize(200, 200))) ++wrong;
+    }
+
+    printf("\ngeometry worker: %d of %d frames differ from the frames built on the gui thread\n", wrong, frames);
+
+    return wrong;
+}
+
+/**
+ * @brief a state whose fields all follow from the distance, a torn snapshot mixes the fields of two states
+ */
+static PreciseLandingState consistent_state(int producer, int i)
+{
+    const double distance = producer * 1000 + i * 0.01;
+    return PreciseLandingState(distance, distance * 1e-3, -distance * 2e-3);
+}
+
+static bool is_consistent(const PreciseLandingState &st)
+{
+    return (st.direction == st.distance * 1e-3 && st.uav_angle == -st.distance * 2e-3);
+}
+
+/**
+ * @brief producer threads publish consistent states without pause,
+ * meanwhile the gui thread reads `state()` and builds frames with `update_ui`
+ * @return the torn snapshots read or drawn
+ */
+static int check_seq_lock()
+{
+    PreciseLandingAssistCtrl ctrl;
+    ctrl.resize(200, 200);
+    ctrl.set_update_filter(false);
+    ctrl.set_dead_reckoning(false);
+    ctrl.set_trail(false);
+
+    std::atomic<bool> stop(false);
+    std::atomic<qint64> published(0);
+
+    std::vector<std::thread> vecProducers;
+    for (int p = 1; p <= seqlock_producer_count; ++p)
+    {
+        vecProducers.emplace_back([&ctrl, &stop, &published, p]()
+        {
+            for (int i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % 100000)
+            {
+                ctrl.publish_state(consistent_state(p, i));
+                published.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    int torn = 0;
+    int drawn = 0;
+    for (int r = 0; r < seqlock_reads; ++r)
+    {
+        if (!is_consistent(ctrl.state())) ++torn;
+        if (r % 10 != 0) continue;
+
+        // the state of the frame is the state `paintGL` draws
+        ctrl.update_ui();
+        if (!is_consistent(ctrl.frame().state)) ++torn;
+        ++drawn;
+    }
+
+    stop = true;
+    for (auto &producer : vecProducers)
+    {
+        producer.join();
+    }
+
+    // the `update_ui` still queued by the producers
+    QCoreApplication::processEvents();
+    if (!is_consistent(ctrl.frame().state)) ++torn;
+
+    printf("\nseqlock: %lld states published by %d threads, %d reads, %d frames, %d torn snapshots\n",
+           published.load(), seqlock_producer_count, seqlock_reads, drawn, torn);
+
+    return torn;
+}
+
+/**
+ * @brief a state message of a nest with a large payload, the platform center before it and the uav after it,
+ * the numbers have at most 15 significant digits
+ */
+static QByteArray state_message(int i)
+{
+    QByteArray raw;
+    raw.reserve(64 * 1024);
+
+    raw += "{\"pack_alias\": \"nest_7\", \"seq\": " + QByteArray::number(i) + ", \"states\": {";
+    raw += "\"platform_center\": {\"lon\": " + QByteArray::number(113.95 + noise(i, 0, 0) * 0.01, 'f', 9)
+            + ", \"lat\": " + QByteArray::number(22.53 + noise(i, 0, 1) * 0.01, 'f', 9) + ", \"alt\": 12.5}, ";
+
+    raw += "\"battery\": {\"cells\": [";
+    for (int c = 0; c < json_battery_cells; ++c)
+    {
+        if (c > 0) raw += ", ";
+        raw += QByteArray::number(3.7 + noise(i, c, 2) * 0.5, 'f', 4);
+    }
+    raw += "]}, ";
+
+    raw += "\"status\": {";
+    for (int k = 0; k < json_status_items; ++k)
+    {
+        if (k > 0) raw += ", ";
+        raw += "\"item_" + QByteArray::number(k) + "\": {\"ok\": " + (k % 7 ? "true" : "false")
+                + ", \"code\": " + QByteArray::number(k * 31) + ", \"text\": \"door \\\"" + QByteArray::number(k)
+                + "\\\" closed, lon\\u00b0 {lat} [alt]\", \"limits\": [-1e3, 2.5E-2, null]}";
+    }
+    raw += "}, ";
+
+    raw += "\"uav\": {\"lon\": " + QByteArray::number(113.96 + noise(i, 0, 3) * 0.01, 'f', 9)
+            + ", \"lat\": " + QByteArray::number(22.54 + noise(i, 0, 4) * 0.01, 'f', 9) + "}, ";
+
+    // round-trip lon/lat with 17 significant digits, exponents, and more digits than fit 64 bits
+    raw += "\"target\": {\"lon\": " + QByteArray::number(113.95 + noise(i, 0, 5) * 0.01, 'g', 17)
+            + ", \"lat\": " + QByteArray::number(22.53 + noise(i, 0, 6) * 0.01, 'e', 16)
+            + ", \"scale\": " + QByteArray::number(-1.2345678901234567e-5 * (1 + noise(i, 0, 7)), 'e', 16)
+            + ", \"range\": " + QByteArray::number(1234.5678 + noise(i, 0, 8), 'f', 20) + "}";
+    raw += "}}";
+
+    return raw;
+}
+
+static double dom_number(const QJsonObject &joStates, const char *obj, const char *key)
+{
+    return joStates.value(obj).toObject().value(key).toDouble();
+}
+
+/**
+ * @brief the subscribed fields of large state messages, pulled by the selective extractor
+ * and by `QJsonDocument::fromJson` with a lookup of the same paths, both must give the same values
+ * @return the messages whose values differ
+ */
+static int check_json_extractor()
+{
+    QVector<QByteArray> vecMessages;
+    qint64 bytes = 0;
+    for (int i = 0; i < json_message_count; ++i)
+    {
+        vecMessages.push_back(state_message(i));
+        bytes += vecMessages.last().size();
+    }
+
+    JsonSelectiveExtractor extractor;
+    const int slotAlias = extractor.add_path(QStringList() << "pack_alias");
+    const int slotPlatformLon = extractor.add_path(QStringList() << "states" << "platform_center" << "lon");
+    const int slotPlatformLat = extractor.add_path(QStringList() << "states" << "platform_center" << "lat");
+    const int slotUavLon = extractor.add_path(QStringList() << "states" << "uav" << "lon");
+    const int slotUavLat = extractor.add_path(QStringList() << "states" << "uav" << "lat");
+    const int slotTargetLon = extractor.add_path(QStringList() << "states" << "target" << "lon");
+    const int slotTargetLat = extractor.add_path(QStringList() << "states" << "target" << "lat");
+    const int slotTargetScale = extractor.add_path(QStringList() << "states" << "target" << "scale");
+    const int slotTargetRange = extractor.add_path(QStringList() << "states" << "target" << "range");
+
+    volatile double sink = 0;
+
+    QElapsedTimer tm;
+    tm.start();
+    for (int r = 0; r < json_reps; ++r)
+    {
+        for (const auto &raw : vecMessages)
+        {
+            extractor.extract(raw);
+            sink = sink + extractor.number(slotUavLat);
+        }
+    }
+    const double extractUs = static_cast<double>(tm.nsecsElapsed()) / 1000.0 / (json_reps * json_message_count);
+
+    tm.restart();
+    for (int r = 0; r < json_reps; ++r)
+    {
+        for (const auto &raw : vecMessages)
+        {
+            const auto joStates = QJsonDocument::fromJson(raw).object().value("states").toObject();
+            sink = sink + dom_number(joStates, "uav", "lat");
+        }
+    }
+    const double domUs = static_cast<double>(tm.nsecsElapsed()) / 1000.0 / (json_reps * json_message_count);
+
+    int wrong = 0;
+    for (const auto &raw : vecMessages)
+    {
+        const auto jo = QJsonDocument::fromJson(raw).object();
+        const auto joStates = jo.value("states").toObject();
+
+        const bool same = (extractor.extract(raw)
+                           && extractor.string_equals(slotAlias, jo.value("pack_alias").toString().toUtf8())
+                           && extractor.type(slotPlatformLon) == JsonSelectiveExtractor::Number
+                           && extractor.number(slotPlatformLon) == dom_number(joStates, "platform_center", "lon")
+                           && extractor.number(slotPlatformLat) == dom_number(joStates, "platform_center", "lat")
+                           && extractor.number(slotUavLon) == dom_number(joStates, "uav", "lon")
+                           && extractor.number(slotUavLat) == dom_number(joStates, "uav", "lat")
+                           && extractor.number(slotTargetLon) == dom_number(joStates, "target", "lon")
+                           && extractor.number(slotTargetLat) == dom_number(joStates, "target", "lat")
+                           && extractor.number(slotTargetScale) == dom_number(joStates, "target", "scale")
+                           && extractor.number(slotTargetRange) == dom_number(joStates, "target", "range"));
+        if (!same) ++wrong;
+    }
+
+    const double kib = static_cast<double>(bytes) / json_message_count / 1024;
+    printf("\nstate message of %.1f KiB, 8 fields: extractor %.1f us (%.0f MiB/s), QJsonDocument %.1f us (%.0f MiB/s)\n",
+           kib, extractUs, kib / 1024 / extractUs * 1e6, domUs, kib / 1024 / domUs * 1e6);
+    printf("messages whose fields differ between the two: %d of %d\n", wrong, json_message_count);
+
+    return wrong;
+}
+
+/**
+ * @brief GeodesyTolerance
+ * errors allowed to a method at the range of the reference, and at the range of a uav near its platform
+ */
+struct GeodesyTolerance
+{
+    Geodesy::Method method;
+    const char      *name;
+    double          reference_m;
+    double          reference_deg;
+    double          near_m;
+    double          near_deg;
+    bool            simd_batch;     // the batch call must beat one call per point
+};
+
+static const GeodesyTolerance geodesy_tolerances[] =
+{
+    {Geodesy::Equirectangular,  "equirect",     200,    0.5,    1,  0.25,   true},
+    {Geodesy::Haversine,        "haversine",    100,    0.25,   1,  0.25,   true},
+    {Geodesy::Vincenty,         "vincenty",     1e-3,   1e-5,   0,  0,      false}
+};
+
+static double bearing_error_deg(double bearingRad, double deg)
+{
+    const double d = std::fmod(std::fabs(bearingRad * rad_2_deg - deg), 360.0);
+    return qMin(d, 360 - d);
+}
+
+/**
+ * @brief every method against the Flinders Peak to Buninyong reference, the spherical ones also against Vincenty
+ * near the platform, then the batch call against one call per point, the same results and,
+ * for the sse2 methods of an optimized build, less time per point
+ * @return the results out of tolerance
+ */
+static int check_geodesy()
+{
+    QVector<double> vecLons(geodesy_point_count);
+    QVector<double> vecLats(geodesy_point_count);
+    QVector<double> vecDistances(geodesy_point_count);
+    QVector<double> vecBearings(geodesy_point_count);
+    for (int i = 0; i < geodesy_point_count; ++i)
+    {
+        vecLons[i] = platform_lon + noise(i, 0, 9) * 0.05;
+        vecLats[i] = platform_lat + noise(i, 0, 10) * 0.05;
+    }
+
+    Geodesy vincenty(Geodesy::Vincenty);
+    vincenty.set_origin(platform_lon, platform_lat);
+    const auto nearRef = vincenty.range_bearing(near_uav_lon, near_uav_lat);
+
+    printf("\ngeodesy, error against Flinders Peak - Buninyong and against vincenty near the platform, ns per point\n");
+    printf("%10s %10s %10s %10s %10s %10s %10s %10s\n", "method", "ref m", "ref deg", "near m", "near deg", "scalar", "batch",
+           "batch m");
+
+    volatile double sink = 0;
+    int wrong = 0;
+    for (const auto &tol : geodesy_tolerances)
+    {
+        Geodesy geodesy(tol.method);
+
+        geodesy.set_origin(flinders_lon, flinders_lat);
+        const auto rb = geodesy.range_bearing(buninyong_lon, buninyong_lat);
+        const double refM = std::fabs(rb.distance - flinders_buninyong_m);
+        const double refDeg = bearing_error_deg(rb.bearing, flinders_buninyong_deg);
+
+        geodesy.set_origin(platform_lon, platform_lat);
+        const auto rbNear = geodesy.range_bearing(near_uav_lon, near_uav_lat);
+        const double nearM = std::fabs(rbNear.distance - nearRef.distance);
+        const double nearDeg = bearing_error_deg(rbNear.bearing, nearRef.bearing * rad_2_deg);
+
+        if (refM > tol.reference_m || refDeg > tol.reference_deg || nearM > tol.near_m || nearDeg > tol.near_deg)
+        {
+            ++wrong;
+        }
+
+        QElapsedTimer tm;
+        tm.start();
+        for (int r = 0; r < geodesy_reps; ++r)
+        {
+            for (int i = 0; i < geodesy_point_count; ++i)
+            {
+                sink = sink + geodesy.range_bearing(vecLons.at(i), vecLats.at(i)).distance;
+            }
+        }
+        const double scalarNs = static_cast<double>(tm.nsecsElapsed()) / (geodesy_reps * geodesy_point_count);
+
+        tm.restart();
+        for (int r = 0; r < geodesy_reps; ++r)
+        {
+            geodesy.range_bearing(vecLons.constData(), vecLats.constData(), geodesy_point_count,
+                                  vecDistances.data(), vecBearings.data());
+            sink = sink + vecDistances.at(r);
+        }
+        const double batchNs = static_cast<double>(tm.nsecsElapsed()) / (geodesy_reps * geodesy_point_count);
+
+        double batchM = 0;
+        double batchDeg = 0;
+        for (int i = 0; i < geodesy_point_count; ++i)
+        {
+            const auto rbPoint = geodesy.range_bearing(vecLons.at(i), vecLats.at(i));
+            batchM = qMax(batchM, std::fabs(vecDistances.at(i) - rbPoint.distance));
+            batchDeg = qMax(batchDeg, bearing_error_deg(vecBearings.at(i), rbPoint.bearing * rad_2_deg));
+        }
+
+        if (batchM > geodesy_batch_max_m || batchDeg > geodesy_batch_max_deg) ++wrong;
+
+#ifdef QT_NO_DEBUG
+        if (tol.simd_batch && batchNs >= scalarNs) ++wrong;
+#endif
+
+        printf("%10s %10.4f %10.6f %10.4f %10.6f %10.1f %10.1f %10.2g\n", tol.name, refM, refDeg, nearM, nearDeg,
+               scalarNs, batchNs, batchM);
+    }
+
+    printf("methods out of tolerance: %d\n", wrong);
+
+    return wrong;
+}
+
+/**
+ * @brief the uav as the ctrl draws it, read from its built frame:
+ * the device pixel it is placed at, the angle it is turned by and its distance text
+ */
+struct DrawnUav
+{
+    int         x;
+    int         y;
+    bool        inside;
+    double      angle;
+    QString     text;
+};
+
+static DrawnUav drawn_uav(const PreciseLandingAssistCtrl &ctrl)
+{
+    const auto &frame = ctrl.frame();
+    const QPointF px = frame.transform.to_pixel(frame.uav_pos);
+
+    DrawnUav uav;
+    uav.x = qRound(px.x());
+    uav.y = qRound(px.y());
+    uav.inside = frame.uav_inside;
+    uav.angle = (frame.uav_inside ? frame.state.uav_angle : frame.state.direction);
+    uav.text = frame.str_distance;
+
+    return uav;
+}
+
+// pixels of the farthest vertex of the uav triangle from the point it turns about
+static double uav_tip_px(const PreciseLandingAssistCtrl &ctrl, bool inside)
+{
+    double tip = 0;
+    for (const auto &pt : ctrl.uav_shape(inside))
+    {
+        tip = qMax(tip, std::sqrt(pt.x*pt.x + pt.y*pt.y));
+    }
+
+    const QRect rc = ctrl.frame().transform.viewport();
+    return tip * qMax(rc.width(), rc.height()) / 2.0;
+}
+
+/**
+ * @brief feed the noisy approach to a filtered ctrl and to a twin without the filter, which builds every sample,
+ * a sample is dropped wrongly if the frame the twin built for it places the uav on another pixel,
+ * turns its tip by a pixel or more, or shows another text than the frame the filtered ctrl still shows,
+ * the pixels the two renders differ in are reported, they differ by antialiasing only
+ * @return the number of wrongly dropped samples
+ */
+static int check_update_filter()
+{
+    PreciseLandingAssistCtrl ctrl;
+    PreciseLandingAssistCtrl twin;
+    twin.set_update_filter(false);
+
+    for (auto c : {&ctrl, &twin})
+    {
+        c->resize(200, 200);
+
+        // only the uav itself is compared
+        c->set_dead_reckoning(false);
+        c->set_trail(false);
+
+        // the viewport is set by the first render
+        c->grabFramebuffer();
+    }
+
+    const QSize sz = ctrl.size() * ctrl.devicePixelRatio();
+
+    int dropped = 0;
+    int worstPixels = 0;
+    for (int f = 0; f < bench_frames * 10; ++f)
+    {
+        const auto st = noisy_state(0, f);
+
+        const qint64 suppressed = ctrl.suppressed_updates();
+        for (auto c : {&ctrl, &twin})
+        {
+            c->publish_state(st);
+            c->update_ui();
+        }
+
+        if (ctrl.suppressed_updates() == suppressed) continue;
+
+        const auto shown = drawn_uav(ctrl);
+        const auto built = drawn_uav(twin);
+        const double tipPx = uav_tip_px(twin, built.inside);
+
+        if (shown.x != built.x || shown.y != built.y || shown.inside != built.inside || shown.text != built.text
+                || std::fabs(shown.angle - built.angle) * tipPx >= 1)
+        {
+            ++dropped;
+        }
+
+        worstPixels = qMax(worstPixels, differing_pixels(ctrl.render_image(sz), twin.render_image(sz)));
+    }
+
+    printf("\nupdate filter: %lld of %d samples suppressed, %d visible changes dropped, "
+           "at most %d pixels differ by antialiasing\n",
+           ctrl.suppressed_updates(), bench_frames * 10, dropped, worstPixels);
+
+    return dropped;
+}
+
+/**
+ * @brief the ctrl with the allocations of `paintGL` counted
+ */
+class AllocCountingCtrl : public PreciseLandingAssistCtrl
+{
+public:
+    qint64 paint_allocations = 0;
+
+protected:
+    void paintGL() override
+    {
+        const qint64 before = allocation_count;
+        count_allocations = true;
+        PreciseLandingAssistCtrl::paintGL();
+        count_allocations = false;
+        paint_allocations += allocation_count - before;
+    }
+};
+
+/**
+ * @brief allocations of the gui thread per frame once the ctrl is warm,
+ * a looped approach with a labelled target, every sample is calculated, recorded and painted
+ * @return the allocations of `update_ui` after the warmup
+ */
+static qint64 check_allocations()
+{
+    static const int loop_frames = 120;
+
+    AllocCountingCtrl ctrl;
+    ctrl.resize(200, 200);
+    ctrl.set_update_filter(false);
+    ctrl.set_target(1, script_state(1, 0));
+    ctrl.set_target_labelled(1, true);
+
+    for (int f = 0; f < loop_frames + bench_frames; ++f)
+    {
+        // the first loop reaches the largest sizes of every buffer
+        if (f == loop_frames)
+        {
+            allocation_count = 0;
+            ctrl.paint_allocations = 0;
+        }
+
+        const auto st = script_state(0, f % loop_frames);
+
+        count_allocations = true;
+        ctrl.publish_state(st);
+        ctrl.update_ui();
+        count_allocations = false;
+
+        ctrl.grabFramebuffer();
+    }
+
+    const qint64 updateAllocs = allocation_count - ctrl.paint_allocations;
+
+    printf("\nallocations per frame after warmup: update_ui %.2f, paintGL %.2f (gl driver included)\n",
+           static_cast<double>(updateAllocs) / bench_frames,
+           static_cast<double>(ctrl.paint_allocations) / bench_frames);
+
+    return updateAllocs;
+}
+
+/**
+ * @brief gl -> pixel -> gl round trips over viewports of even and odd sizes with offsets,
+ * the span conversions must give the same results as the single point ones,
+ * the GLFuncUtils pair must be inverse to each other
+ * @return the largest round trip error in pixels, infinity if a span differs
+ */
+static double check_viewport_transform()
+{
+    static const QRect viewports[] =
+    {
+        QRect(0, 0, 200, 200), QRect(0, 0, 401, 299), QRect(37, -12, 1920, 1080), QRect(5, 5, 1, 1)
+    };
+    static const int point_count = 1000;
+
+    PreciseLandingAssistCtrl ctrl;
+
+    QVector<GLPoint2f> vecGl(point_count);
+    QVector<QPointF> vecPixels(point_count);
+    QVector<GLPoint2f> vecBack(point_count);
+
+    double worst = 0;
+    for (const auto &rc : viewports)
+    {
+        const ViewportTransform transform(rc);
+
+        // a bit beyond the viewport on every side
+        for (int i = 0; i < point_count; ++i)
+        {
+            vecGl[i] = GLPoint2f(static_cast<float>(noise(i, rc.width(), 3) * 1.5),
+                                 static_cast<float>(noise(i, rc.height(), 4) * 1.5));
+        }
+
+        transform.to_pixels(vecGl.constData(), vecPixels.data(), point_count);
+        transform.to_gl(vecPixels.constData(), vecBack.data(), point_count);
+
+        for (int i = 0; i < point_count; ++i)
+        {
+            const QPointF px = transform.to_pixel(vecGl.at(i));
+            const GLPoint2f gl = transform.to_gl(vecPixels.at(i));
+            if (px.x() != vecPixels.at(i).x() || px.y() != vecPixels.at(i).y()
+                    || gl.x != vecBack.at(i).x || gl.y != vecBack.at(i).y)
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+
+            const QPointF d1 = transform.to_pixel(vecBack.at(i)) - px;
+            worst = qMax(worst, std::sqrt(d1.x()*d1.x() + d1.y()*d1.y()));
+
+            const QPointF pxUtils = ctrl.gl_point_2_qpointf(vecGl.at(i), rc);
+            const QPointF d2 = ctrl.gl_point_2_qpointf(ctrl.qpointf_2_gl_point(pxUtils, rc), rc) - pxUtils;
+            worst = qMax(worst, std::sqrt(d2.x()*d2.x() + d2.y()*d2.y()));
+        }
+    }
+
+    printf("\nviewport transform: %.2e px round trip error at most (limit %.0e px)\n", worst, transform_max_error_px);
+
+    // the spans against one call per point, in a 1080p viewport
+    static const int timed_reps = 200;
+
+    const ViewportTransform transform(QRect(0, 0, 1920, 1080));
+    volatile double sink = 0;
+
+    QElapsedTimer tm;
+    tm.start();
+    for (int r = 0; r < timed_reps; ++r)
+    {
+        for (int i = 0; i < point_count; ++i)
+        {
+            vecPixels[i] = transform.to_pixel(vecGl.at(i));
+        }
+        sink = sink + vecPixels.at(r % point_count).x();
+    }
+    const double pixelNs = static_cast<double>(tm.nsecsElapsed()) / (timed_reps * point_count);
+
+    tm.restart();
+    for (int r = 0; r < timed_reps; ++r)
+    {
+        transform.to_pixels(vecGl.constData(), vecPixels.data(), point_count);
+        sink = sink + vecPixels.at(r % point_count).x();
+    }
+    const double pixelsNs = static_cast<double>(tm.nsecsElapsed()) / (timed_reps * point_count);
+
+    tm.restart();
+    for (int r = 0; r < timed_reps; ++r)
+    {
+        for (int i = 0; i < point_count; ++i)
+        {
+            vecBack[i] = transform.to_gl(vecPixels.at(i));
+        }
+        sink = sink + vecBack.at(r % point_count).x;
+    }
+    const double glNs = static_cast<double>(tm.nsecsElapsed()) / (timed_reps * point_count);
+
+    tm.restart();
+    for (int r = 0; r < timed_reps; ++r)
+    {
+        transform.to_gl(vecPixels.constData(), vecBack.data(), point_count);
+        sink = sink + vecBack.at(r % point_count).x;
+    }
+    const double glsNs = static_cast<double>(tm.nsecsElapsed()) / (timed_reps * point_count);
+
+    printf("ns per point, gl -> pixel: point %.2f, span %.2f; pixel -> gl: point %.2f, span %.2f\n",
+           pixelNs, pixelsNs, glNs, glsNs);
+
+    return worst;
+}
+
+/**
+ * @brief pixel position of a fleet marker in a 400 px ctrl, a fifth of the fleet is clamped to the rim
+ */
+static QPointF pick_marker_pos(int id, int frame)
+{
+    static const double rim_px = 0.6 * 200;
+
+    const double d = qMin((noise(id, frame, 5) + 1) * 0.6, 1.0);
+    const double a = noise(id, frame, 6) * PI;
+    return QPointF(200 + rim_px * d * std::cos(a), 200 - rim_px * d * std::sin(a));
+}
+
+/**
+ * @brief hit queries, incremental moves and zoom rebuilds of the picking grid at `pick_target_count` markers,
+ * every query is checked against a search of all markers
+ * @return the queries whose pick is not the nearest marker within the pick radius
+ */
+static int check_picking()
+{
+    QVector<QPointF> vecPos(pick_target_count);
+    for (int i = 0; i < pick_target_count; ++i)
+    {
+        vecPos[i] = pick_marker_pos(i, 0);
+    }
+
+    QElapsedTimer tm;
+    TargetGrid grid;
+    grid.set_bounds(QRectF(0, 0, 400, 400), pick_cell_px);
+    for (int i = 0; i < pick_target_count; ++i)
+    {
+        grid.update(i, vecPos.at(i));
+    }
+
+    // hit queries, a third of them right on a marker
+    QVector<QPointF> vecQueries(pick_query_count);
+    for (int q = 0; q < pick_query_count; ++q)
+    {
+        vecQueries[q] = (q % 3 == 0 ? vecPos.at(q % pick_target_count) + QPointF(noise(q, 1, 7) * 3, noise(q, 1, 8) * 3)
+                                    : QPointF(200 + noise(q, 2, 7) * 200, 200 + noise(q, 2, 8) * 200));
+    }
+
+    int hits = 0;
+    tm.start();
+    for (const auto &pt : vecQueries)
+    {
+        if (grid.pick(pt, pick_radius_px) >= 0) ++hits;
+    }
+    const double queryNs = static_cast<double>(tm.nsecsElapsed()) / pick_query_count;
+
+    int wrong = 0;
+    for (int q = 0; q < pick_query_count; q += 97)
+    {
+        const QPointF &pt = vecQueries.at(q);
+
+        double best = pick_radius_px * pick_radius_px;
+        bool found = false;
+        for (const auto &pos : vecPos)
+        {
+            const QPointF d = pos - pt;
+            const double d2 = d.x()*d.x() + d.y()*d.y();
+            if (d2 > best) continue;
+
+            best = d2;
+            found = true;
+        }
+
+        const int id = grid.pick(pt, pick_radius_px);
+        const QPointF d = (id >= 0 ? vecPos.at(id) - pt : QPointF());
+        if (found != (id >= 0) || (found && d.x()*d.x() + d.y()*d.y() != best)) ++wrong;
+    }
+
+    // a frame of telemetry, every marker moves a little
+    static const int move_frames = 20;
+    tm.start();
+    for (int f = 1; f <= move_frames; ++f)
+    {
+        for (int i = 0; i < pick_target_count; ++i)
+        {
+            const QPointF pt = vecPos.at(i) + QPointF(noise(i, f, 7), noise(i, f, 8));
+            grid.update(i, pt);
+        }
+    }
+    const double moveNs = static_cast<double>(tm.nsecsElapsed()) / (move_frames * pick_target_count);
+
+    // a zoom step, every marker moves far
+    tm.start();
+    for (int f = 1; f <= move_frames; ++f)
+    {
+        grid.begin_bulk();
+        for (int i = 0; i < pick_target_count; ++i)
+        {
+            grid.update(i, pick_marker_pos(i, f));
+        }
+        grid.end_bulk();
+    }
+    const double rebuildUs = static_cast<double>(tm.nsecsElapsed()) / move_frames / 1000.0;
+
+    printf("\npicking %d markers: query %.0f ns (%d%% hits), move %.0f ns per marker, zoom rebuild %.0f us\n",
+           pick_target_count, queryNs, hits * 100 / pick_query_count, moveNs, rebuildUs);
+    printf("picks that are not the nearest marker: %d\n", wrong);
+
+    return wrong;
+}
+
+/**
+ * @brief the 360 cos/sin pairs per ellipse of the old `draw_ellipse`, the reference of the table path
+ */
+static void ellipse_vertices_360(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, QVector<GLPoint2f> &vecPts)
+{
+    static const int count = 360;
+    static const float angle_unit = static_cast<float>(2 * PI / count);
+
+    vecPts.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const float angle = angle_unit * i;
+        vecPts[i] = GLPoint2f(ptCenter.x + rx * std::cos(angle), ptCenter.y + ry * std::sin(angle));
+    }
+}
+
+/**
+ * @brief tessellation time per ellipse, 360 cos/sin pairs against the unit circle table sampled at the segment count
+ * of the pixel radius, every chord of the table path must stay within the chord error
+ * @return the ellipses whose chords stray further
+ */
+static int check_ellipse_tessellation()
+{
+    static const int reps = 20000;
+
+    GLFuncUtils utils;
+    QVector<GLPoint2f> vecPts;
+    volatile float sink = 0;
+
+    printf("\nellipse tessellation, ns per ellipse, 360 cos/sin pairs vs the unit circle table\n");
+    printf("%8s %8s %10s %10s %10s %10s %12s\n", "px", "radius", "360 verts", "360 ns", "table verts", "table ns",
+           "chord err px");
+
+    int wrong = 0;
+    for (auto px : ellipse_viewport_px)
+    {
+        utils.set_viewport_size(px, px);
+
+        for (auto r : ellipse_radii)
+        {
+            QElapsedTimer tm;
+            tm.start();
+            for (int i = 0; i < reps; ++i)
+            {
+                ellipse_vertices_360(GLPoint2f(0, i * 1e-6f), r, r, vecPts);
+                sink = sink + vecPts.at(i % vecPts.size()).x;
+            }
+            const double oldNs = static_cast<double>(tm.nsecsElapsed()) / reps;
+
+            tm.restart();
+            for (int i = 0; i < reps; ++i)
+            {
+                utils.ellipse_vertices(GLPoint2f(0, i * 1e-6f), r, r, vecPts);
+                sink = sink + vecPts.at(i % vecPts.size()).x;
+            }
+            const double tableNs = static_cast<double>(tm.nsecsElapsed()) / reps;
+
+            // the sagitta of one chord of the table path
+            const double radiusPx = r * px / 2.0;
+            const double errorPx = radiusPx * (1 - std::cos(PI / vecPts.size()));
+            if (errorPx > ellipse_max_chord_error_px) ++wrong;
+
+            printf("%8d %8.2f %10d %10.1f %10d %10.1f %12.3f\n", px, r, 360, oldNs, vecPts.size(), tableNs, errorPx);
+        }
+    }
+
+    printf("ellipses beyond %.2f px chord error: %d\n", ellipse_max_chord_error_px, wrong);
+
+    return wrong;
+}
+
+/**
+ * @brief per stage times of the ctrl profiler, summed over the cards
+ */
+static void run_profile(int cardCount)
+{
+    QVector<PreciseLandingAssistCtrl *> vecCtrls;
+    for (int i = 0; i < cardCount; ++i)
+    {
+        auto ctrl = new PreciseLandingAssistCtrl();
+        ctrl->resize(200, 200);
+        ctrl->set_profiling(true);
+        vecCtrls.push_back(ctrl);
+    }
+
+    for (int f = 0; f < warmup_frames + FrameProfiler::window_size; ++f)
+    {
+        for (int i = 0; i < cardCount; ++i)
+        {
+            auto ctrl = vecCtrls.at(i);
+            ctrl->publish_state(script_state(i, f));
+            ctrl->update_ui();
+            ctrl->grabFramebuffer();
+        }
+    }
+
+    for (int stage = 0; stage < FrameProfiler::StageCount; ++stage)
+    {
+        double cpu50 = 0, cpu99 = 0, gpu50 = 0, gpu99 = 0;
+        for (auto ctrl : vecCtrls)
+        {
+            const auto &profiler = ctrl->profiler();
+            cpu50 += profiler.cpu_percentile(stage, 0.5);
+            cpu99 += profiler.cpu_percentile(stage, 0.99);
+            gpu50 += profiler.gpu_percentile(stage, 0.5);
+            gpu99 += profiler.gpu_percentile(stage, 0.99);
+        }
+
+        printf("%10s %10.1f %10.1f %10.1f %10.1f\n", FrameProfiler::stage_name(stage), cpu50, cpu99, gpu50, gpu99);
+    }
+
+    qDeleteAll(vecCtrls);
+}
+
+/**
+ * headless render benchmark of PreciseLandingAssistCtrl
+ * the ctrls are never shown, every frame is rendered into their framebuffers,
+ * the software rasterizer of mesa (llvmpipe) is used unless the environment says otherwise
+ */
+int main(int argc, char **argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE")) qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QApplication app(argc, argv);
+
+    printf("frame cpu time in us, %d frames after %d warmup frames\n", bench_frames, warmup_frames);
+    printf("%6s %8s %10s %10s %10s %10s %10s %12s %14s\n",
+           "cards", "samples", "mean", "p50", "p90", "p99", "max", "draw calls", "gpu KiB/card");
+
+    for (auto samples : msaa_samples)
+    {
+        for (auto cardCount : card_counts)
+        {
+            run(cardCount, samples);
+        }
+    }
+
+    printf("\nframe to image in us, gl vs raster backend\n");
+    printf("%6s %10s %10s %10s %10s\n", "cards", "gl mean", "gl p99", "cpu mean", "cpu p99");
+
+    for (auto cardCount : card_counts)
+    {
+        run_backends(cardCount);
+    }
+
+    printf("\nall cards in one host, frame cpu time in us\n");
+    printf("%6s %10s %10s %10s %12s\n", "cards", "mean", "p50", "p99", "draw calls");
+
+    for (auto cardCount : card_counts)
+    {
+        run_hosted(cardCount);
+    }
+
+    printf("\nhovering uav, frame time in us including the render, redundant frames elided or not\n");
+    printf("%6s %8s %10s %10s %10s\n", "cards", "elision", "mean", "p99", "painted");
+
+    for (auto cardCount : card_counts)
+    {
+        run_stationary(cardCount, false);
+        run_stationary(cardCount, true);
+    }
+
+    printf("\nslow approach under gps noise, frame time in us including the render, filtered or not\n");
+    printf("%6s %8s %10s %10s %10s\n", "cards", "filter", "mean", "p99", "painted");
+
+    for (auto cardCount : card_counts)
+    {
+        run_noisy(cardCount, false);
+        run_noisy(cardCount, true);
+    }
+
+    printf("\nfleet beyond the radius, frame time and targets stage cpu time in us\n");
+    printf("%8s %10s %10s %12s %12s\n", "targets", "mean", "p99", "targets p50", "targets p99");
+
+    for (auto targetCount : rim_target_counts)
+    {
+        run_rim_targets(targetCount);
+    }
+
+    printf("\nmoving fleet, gui thread time per frame in us, the frame built on the gui thread or on the worker pool\n");
+    printf("%8s %8s %10s %10s %10s %10s\n", "targets", "worker", "update", "update p99", "gui", "gui p99");
+
+    for (auto targetCount : worker_target_counts)
+    {
+        run_geometry_worker(targetCount, false);
+        run_geometry_worker(targetCount, true);
+    }
+
+    printf("\nstage time in us of %d cards, sum of the per card percentiles\n", profile_card_count);
+    printf("%10s %10s %10s %10s %10s\n", "stage", "cpu p50", "cpu p99", "gpu p50", "gpu p99");
+    run_profile(profile_card_count);
+
+    const int coarseEllipses = check_ellipse_tessellation();
+
+    const double diffPercent = check_parity();
+    printf("\nbackend parity: %.2f%% pixels differ at most (limit %.2f%%)\n", diffPercent, parity_max_diff_percent);
+
+    const int wrongJson = check_json_extractor();
+    const int wrongGeodesy = check_geodesy();
+    const int torn = check_seq_lock();
+    const int dropped = check_update_filter();
+    const qint64 allocs = check_allocations();
+    const double transformError = check_viewport_transform();
+    const int wrongPicks = check_picking();
+    const int wrongBins = check_rim_clusters() + check_rim_picking();
+    const int wrongFrames = check_geometry_worker();
+
+    const bool failed = (coarseEllipses > 0
+                         || diffPercent > parity_max_diff_percent
+                         || wrongJson > 0
+                         || wrongGeodesy > 0
+                         || torn > 0
+                         || dropped > 0
+                         || allocs > 0
+                         || transformError > transform_max_error_px
+                         || wrongPicks > 0
+                         || wrongBins > 0
+                         || wrongFrames > 0);
+
+    return (failed ? 1 : 0);
+}
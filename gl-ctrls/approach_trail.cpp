@@ -0,0 +1,260 @@
+#include "approach_trail.h"
+
+#include <cmath>
+
+
+static_assert(ApproachTrail::capacity % ApproachTrail::chunk_size == 0, "chunks must not straddle the end of the ring");
+
+// re-simplify only when the tolerance changes by more than it
+static const double tolerance_change = 0.01;
+
+
+// distance from p to the segment a-b
+static inline float segment_distance(const TrailSample &p, const TrailSample &a, const TrailSample &b)
+{
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len2 = dx*dx + dy*dy;
+
+    float u = 0;
+    if (len2 > 0)
+    {
+        u = ((p.x - a.x)*dx + (p.y - a.y)*dy) / len2;
+        u = (u < 0 ? 0 : (u > 1 ? 1 : u));
+    }
+
+    const float ex = p.x - (a.x + u*dx);
+    const float ey = p.y - (a.y + u*dy);
+
+    return std::sqrt(ex*ex + ey*ey);
+}
+
+
+ApproachTrail::ApproachTrail()
+    : _vec_samples(capacity), _duration(180), _tolerance(0),
+      _vec_chunk_indices(chunk_count)
+{
+    _vec_keep.resize(chunk_size + 1);
+    _vec_stack.reserve(2 * (chunk_size + 1));
+
+    // the largest sizes up front, adding samples never allocates
+    for (auto &vec : _vec_chunk_indices)
+    {
+        vec.reserve(chunk_size + 1);
+    }
+    _vec_indices.reserve(capacity + 1);
+
+    clear();
+}
+
+void ApproachTrail::clear()
+{
+    _end_seq = 0;
+    _start_time = 0;
+
+    for (auto &vec : _vec_chunk_indices)
+    {
+        vec.clear();
+    }
+
+    _vec_indices.clear();
+    _indices_changed = true;
+}
+
+bool ApproachTrail::is_empty() const
+{
+    return (_end_seq == 0);
+}
+
+void ApproachTrail::add_sample(double t, double x, double y)
+{
+    if (is_empty()) _start_time = t;
+
+    auto &s = _vec_samples[slot(_end_seq)];
+    s.x = static_cast<float>(x);
+    s.y = static_cast<float>(y);
+    s.t = static_cast<float>(t - _start_time);
+
+    ++_end_seq;
+
+    // the first sample of a chunk closes the one before it
+    const qint64 seq = _end_seq - 1;
+    if (seq == 0 || seq % chunk_size != 0) return;
+
+    simplify_chunk(seq / chunk_size - 1);
+    build_indices();
+}
+
+qint64 ApproachTrail::begin_seq() const
+{
+    return (_end_seq > capacity ? _end_seq - capacity : 0);
+}
+
+qint64 ApproachTrail::end_seq() const
+{
+    return _end_seq;
+}
+
+int ApproachTrail::slot(qint64 seq) const
+{
+    return static_cast<int>(seq % capacity);
+}
+
+const TrailSample &ApproachTrail::sample(qint64 seq) const
+{
+    return _vec_samples.at(slot(seq));
+}
+
+double ApproachTrail::start_time() const
+{
+    return _start_time;
+}
+
+void ApproachTrail::set_duration(double s)
+{
+    if (s <= 0) return;
+
+    _duration = s;
+    build_indices();
+}
+
+double ApproachTrail::duration() const
+{
+    return _duration;
+}
+
+void ApproachTrail::set_tolerance(double d)
+{
+    if (d < 0) return;
+    if (std::fabs(d - _tolerance) <= tolerance_change * _tolerance) return;
+
+    _tolerance = d;
+
+    const qint64 closed = closed_chunk_count();
+    const qint64 first = (begin_seq() + chunk_size - 1) / chunk_size;
+    for (qint64 chunk = first; chunk < closed; ++chunk)
+    {
+        simplify_chunk(chunk);
+    }
+
+    build_indices();
+}
+
+double ApproachTrail::tolerance() const
+{
+    return _tolerance;
+}
+
+bool ApproachTrail::indices_changed() const
+{
+    return _indices_changed;
+}
+
+const QVector<quint32> &ApproachTrail::take_indices()
+{
+    _indices_changed = false;
+    return _vec_indices;
+}
+
+const QVector<quint32> &ApproachTrail::indices() const
+{
+    return _vec_indices;
+}
+
+int ApproachTrail::tail_slot() const
+{
+    return slot(closed_chunk_count() * chunk_size);
+}
+
+int ApproachTrail::tail_count() const
+{
+    return static_cast<int>(_end_seq - closed_chunk_count() * chunk_size);
+}
+
+/**
+ * @brief ApproachTrail::simplify_chunk
+ * iterative Douglas-Peucker over the samples of one chunk, both ends are always kept
+ */
+void ApproachTrail::simplify_chunk(qint64 chunk)
+{
+    const qint64 first = chunk * chunk_size;
+    const int n = chunk_size + 1;
+
+    for (int i = 0; i < n; ++i)
+    {
+        _vec_keep[i] = 0;
+    }
+    _vec_keep[0] = 1;
+    _vec_keep[n - 1] = 1;
+
+    _vec_stack.clear();
+    _vec_stack << 0 << n - 1;
+
+    while (!_vec_stack.isEmpty())
+    {
+        const int b = _vec_stack.takeLast();
+        const int a = _vec_stack.takeLast();
+
+        const auto &sa = sample(first + a);
+        const auto &sb = sample(first + b);
+
+        float maxDist = 0;
+        int maxIdx = -1;
+        for (int i = a + 1; i < b; ++i)
+        {
+            const float d = segment_distance(sample(first + i), sa, sb);
+            if (d > maxDist)
+            {
+                maxDist = d;
+                maxIdx = i;
+            }
+        }
+
+        if (maxIdx < 0 || maxDist <= _tolerance) continue;
+
+        _vec_keep[maxIdx] = 1;
+        _vec_stack << a << maxIdx << maxIdx << b;
+    }
+
+    auto &vec = _vec_chunk_indices[static_cast<int>(chunk % chunk_count)];
+    vec.clear();
+    for (int i = 0; i < n; ++i)
+    {
+        if (_vec_keep.at(i)) vec.push_back(static_cast<quint32>(slot(first + i)));
+    }
+}
+
+/**
+ * @brief ApproachTrail::build_indices
+ * join the closed chunks still in the ring and within `duration`, the shared end of two chunks is kept once
+ */
+void ApproachTrail::build_indices()
+{
+    _vec_indices.clear();
+    _indices_changed = true;
+
+    if (is_empty()) return;
+
+    const qint64 closed = closed_chunk_count();
+    const float minTime = sample(_end_seq - 1).t - static_cast<float>(_duration);
+
+    qint64 chunk = (begin_seq() + chunk_size - 1) / chunk_size;
+    while (chunk < closed && sample((chunk + 1) * chunk_size).t < minTime)
+    {
+        ++chunk;
+    }
+
+    for (; chunk < closed; ++chunk)
+    {
+        const auto &vec = _vec_chunk_indices.at(static_cast<int>(chunk % chunk_count));
+        for (int i = (_vec_indices.isEmpty() ? 0 : 1); i < vec.size(); ++i)
+        {
+            _vec_indices.push_back(vec.at(i));
+        }
+    }
+}
+
+qint64 ApproachTrail::closed_chunk_count() const
+{
+    return (_end_seq > 0 ? (_end_seq - 1) / chunk_size : 0);
+}
@@ -0,0 +1,95 @@
+#ifndef APPROACH_TRAIL_H
+#define APPROACH_TRAIL_H
+
+#include <QVector>
+
+
+/**
+ * @brief The TrailSample struct
+ * x, y: meter, east and north of tgt
+ * t: second since the first sample of the trail
+ */
+struct TrailSample
+{
+    float   x;
+    float   y;
+    float   t;
+};
+
+/**
+ * @brief The ApproachTrail class
+ * past uav positions in a fixed ring, the newest sample overwrites the oldest,
+ * the ring is split into chunks of `chunk_size` samples, a chunk is simplified with Douglas-Peucker once it is closed,
+ * the open chunk at the head is drawn as it is,
+ * the simplified chunks and the open chunk join into one line strip of ring slots
+ */
+class ApproachTrail
+{
+public:
+    static const int capacity = 4096;
+    static const int chunk_size = 64;
+
+public:
+    ApproachTrail();
+
+    void clear();
+    bool is_empty() const;
+
+    // t: second, from any monotonic clock
+    void add_sample(double t, double x, double y);
+
+    // sequence numbers count every sample ever added, [begin_seq, end_seq) are still in the ring
+    qint64 begin_seq() const;
+    qint64 end_seq() const;
+    int slot(qint64 seq) const;
+    const TrailSample &sample(qint64 seq) const;
+
+    // second of the first sample on the clock of `add_sample`
+    double start_time() const;
+
+    // chunks older than it are left out of the line strip
+    void set_duration(double s);
+    double duration() const;
+
+    // meter, the largest deviation of a simplified chunk, changing it simplifies every chunk again
+    void set_tolerance(double d);
+    double tolerance() const;
+
+    // slots of the simplified chunks, changed when a chunk closes or the tolerance changes
+    bool indices_changed() const;
+    const QVector<quint32> &take_indices();
+    const QVector<quint32> &indices() const;
+
+    // the open chunk, contiguous in the ring
+    int tail_slot() const;
+    int tail_count() const;
+
+private:
+    void simplify_chunk(qint64 chunk);
+    void build_indices();
+
+    qint64 closed_chunk_count() const;
+
+private:
+    static const int chunk_count = capacity / chunk_size;
+
+    QVector<TrailSample>    _vec_samples;
+    qint64      _end_seq;
+    double      _start_time;
+
+    double      _duration;
+    double      _tolerance;
+
+    // simplified slots of each closed chunk, both ends included, indexed by chunk % chunk_count
+    QVector<QVector<quint32>>   _vec_chunk_indices;
+
+    QVector<quint32>    _vec_indices;
+    bool                _indices_changed;
+
+    // Douglas-Peucker scratch
+    QVector<char>       _vec_keep;
+    QVector<int>        _vec_stack;
+
+};
+
+#endif // APPROACH_TRAIL_H
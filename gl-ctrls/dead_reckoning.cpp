@@ -0,0 +1,176 @@
+#include "dead_reckoning.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+static const double PI = 3.14159265358979323846;
+static const double min_distance = 1e-9;
+
+
+static inline double wrap_pi(double a)
+{
+    return a - 2*PI * std::floor(a / (2*PI) + 0.5);
+}
+
+
+DeadReckoning::DeadReckoning()
+    : _horizon(0.25), _snap_back(0.1)
+{
+    clear();
+}
+
+void DeadReckoning::set_horizon(double s)
+{
+    if (s < 0) return;
+
+    _horizon = s;
+}
+
+double DeadReckoning::horizon() const
+{
+    return _horizon;
+}
+
+void DeadReckoning::set_snap_back(double s)
+{
+    if (s < 0) return;
+
+    _snap_back = s;
+}
+
+double DeadReckoning::snap_back() const
+{
+    return _snap_back;
+}
+
+void DeadReckoning::clear()
+{
+    _head = 0;
+    _count = 0;
+
+    _vx = 0;
+    _vy = 0;
+    _turn_rate = 0;
+
+    _snap_offset.x = 0;
+    _snap_offset.y = 0;
+    _snap_offset.heading = 0;
+}
+
+bool DeadReckoning::is_empty() const
+{
+    return (_count == 0);
+}
+
+/**
+ * @brief DeadReckoning::add_sample
+ * @param t: time the sample arrived
+ * @param st: direction turns counterclockwise from the north, as in the ctrl
+ */
+void DeadReckoning::add_sample(double t, const PreciseLandingState &st)
+{
+    // what is on screen right now, the new prediction starts from there
+    const bool hadSamples = (_count > 0);
+    Motion shown = {0, 0, 0};
+    if (hadSamples)
+    {
+        shown = displayed(t);
+    }
+
+    Sample s;
+    s.t = t;
+    s.x = -st.distance * std::sin(st.direction);
+    s.y = st.distance * std::cos(st.direction);
+    s.heading = st.uav_angle;
+    s.direction = st.direction;
+
+    _samples[_head] = s;
+    _head = (_head + 1) % sample_capacity;
+    _count = std::min(_count + 1, static_cast<int>(sample_capacity));
+
+    // velocity and turn rate over the recent samples
+    const int n = std::min(_count, static_cast<int>(velocity_samples));
+    const Sample &newest = sample(0);
+    const Sample &oldest = sample(n - 1);
+    const double dt = newest.t - oldest.t;
+
+    if (n >= 2 && dt > 0)
+    {
+        double dh = 0;
+        for (int i = n - 1; i > 0; --i)
+        {
+            dh += wrap_pi(sample(i - 1).heading - sample(i).heading);
+        }
+
+        _vx = (newest.x - oldest.x) / dt;
+        _vy = (newest.y - oldest.y) / dt;
+        _turn_rate = dh / dt;
+    }
+    else
+    {
+        _vx = 0;
+        _vy = 0;
+        _turn_rate = 0;
+    }
+
+    _snap_offset.x = 0;
+    _snap_offset.y = 0;
+    _snap_offset.heading = 0;
+
+    if (hadSamples && _snap_back > 0)
+    {
+        _snap_offset.x = shown.x - s.x;
+        _snap_offset.y = shown.y - s.y;
+        _snap_offset.heading = wrap_pi(shown.heading - s.heading);
+    }
+}
+
+PreciseLandingState DeadReckoning::predict(double t) const
+{
+    if (_count == 0) return PreciseLandingState();
+
+    const Motion m = displayed(t);
+    const double distance = std::sqrt(m.x*m.x + m.y*m.y);
+    const double direction = (distance > min_distance ? std::atan2(-m.x, m.y) : sample(0).direction);
+
+    return PreciseLandingState(distance, direction, m.heading);
+}
+
+bool DeadReckoning::is_settled(double t) const
+{
+    if (_count == 0) return true;
+
+    return (t >= sample(0).t + std::max(_horizon, _snap_back));
+}
+
+DeadReckoning::Motion DeadReckoning::extrapolate(double t) const
+{
+    const Sample &newest = sample(0);
+    const double dt = std::min(std::max(t - newest.t, 0.0), _horizon);
+
+    Motion m;
+    m.x = newest.x + _vx * dt;
+    m.y = newest.y + _vy * dt;
+    m.heading = newest.heading + _turn_rate * dt;
+
+    return m;
+}
+
+DeadReckoning::Motion DeadReckoning::displayed(double t) const
+{
+    Motion m = extrapolate(t);
+    if (_snap_back <= 0) return m;
+
+    const double fade = std::max(0.0, 1 - (t - sample(0).t) / _snap_back);
+    m.x += _snap_offset.x * fade;
+    m.y += _snap_offset.y * fade;
+    m.heading += _snap_offset.heading * fade;
+
+    return m;
+}
+
+const DeadReckoning::Sample &DeadReckoning::sample(int back) const
+{
+    return _samples[(_head - 1 - back + sample_capacity) % sample_capacity];
+}
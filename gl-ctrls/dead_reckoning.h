@@ -0,0 +1,78 @@
+#ifndef DEAD_RECKONING_H
+#define DEAD_RECKONING_H
+
+#include "precise_landing_state.h"
+
+
+/**
+ * @brief The DeadReckoning class
+ * predict the state between telemetry samples,
+ * the uav moves with the velocity and turns with the turn rate estimated from the recent samples,
+ * the prediction stops at `horizon` after the last sample,
+ * a new sample is blended in over `snap_back` instead of making the marker jump
+ * time: second, from any monotonic clock
+ */
+class DeadReckoning
+{
+public:
+    DeadReckoning();
+
+    void set_horizon(double s);
+    double horizon() const;
+
+    void set_snap_back(double s);
+    double snap_back() const;
+
+    void clear();
+    bool is_empty() const;
+
+    void add_sample(double t, const PreciseLandingState &st);
+    PreciseLandingState predict(double t) const;
+
+    // the prediction will not change any more until the next sample
+    bool is_settled(double t) const;
+
+private:
+    struct Sample
+    {
+        double  t;
+        double  x;
+        double  y;
+        double  heading;
+        double  direction;
+    };
+
+    struct Motion
+    {
+        double  x;
+        double  y;
+        double  heading;
+    };
+
+private:
+    Motion extrapolate(double t) const;
+    Motion displayed(double t) const;
+    const Sample &sample(int back) const;
+
+private:
+    static const int sample_capacity = 8;
+    static const int velocity_samples = 4;
+
+    double      _horizon;
+    double      _snap_back;
+
+    Sample      _samples[sample_capacity];
+    int         _head;
+    int         _count;
+
+    // velocity and turn rate
+    double      _vx;
+    double      _vy;
+    double      _turn_rate;
+
+    // offset from the old prediction to the new one, faded out over `_snap_back`
+    Motion      _snap_offset;
+
+};
+
+#endif // DEAD_RECKONING_H
@@ -0,0 +1,327 @@
+#include "frame_packet.h"
+
+#include <cmath>
+
+
+static const double PI = 3.1415926;
+
+// gl, the range circle and tgt of the ctrl
+static const float circle_f = 0.6f;
+static const float tgt_radius = 0.03f;
+
+// pixel, count badges of the rim chevrons
+static const double rim_badge_w_px = 20;
+static const double rim_badge_h_px = 14;
+
+// gl, width of the outside chevron of a target beyond the radius
+static const float rim_chevron_w = 0.06f;
+
+// decimal digits of v, returns their count
+static int format_uint(char *buf, quint64 v)
+{
+    char tmp[20];
+    int n = 0;
+    do
+    {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    for (int i = 0; i < n; ++i)
+    {
+        buf[i] = tmp[n - 1 - i];
+    }
+
+    return n;
+}
+
+// the ascii in buf written into the storage `txt` already has
+static void assign_latin1(QString &txt, const char *buf, int n)
+{
+    txt.resize(n);
+    QChar *data = txt.data();
+    for (int i = 0; i < n; ++i)
+    {
+        data[i] = QLatin1Char(buf[i]);
+    }
+}
+
+
+FramePacket::FramePacket()
+    : radius(1), uav_inside(false)
+{
+    // fixed storage of the distance mark, assigned in place by `build_uav`
+    distance_lines_pts.resize(3);
+    distance_txt_pts.resize(2);
+}
+
+void FramePacket::build(const FrameInput &in)
+{
+    build(in.state, in.radius, in.transform, in.targets, in.labelled, in.hovered, in.rim, in.labelled_bins,
+          in.hovered_bin);
+}
+
+/**
+ * @brief FramePacket::build
+ * reads nothing but its arguments, any thread may build a packet it owns
+ */
+void FramePacket::build(const PreciseLandingState &st, double r, const ViewportTransform &vt,
+                        const QHash<int, PreciseLandingState> &targets, const QSet<int> &labelled, int hovered,
+                        const RimClusters &rim, const QSet<int> &labelledBins, int hoveredBin)
+{
+    state = st;
+    radius = r;
+    transform = vt;
+
+    build_uav();
+
+    // the labels and their strings are reused, only the count is adjusted at the end
+    int labelCount = 0;
+    build_targets(targets, labelled, hovered, labelCount);
+    build_rim_markers(rim, labelled, hovered, labelledBins, hoveredBin, labelCount);
+    target_labels.resize(labelCount);
+}
+
+void FramePacket::swap(FramePacket &o)
+{
+    qSwap(state, o.state);
+    qSwap(radius, o.radius);
+    qSwap(transform, o.transform);
+
+    qSwap(uav_pos, o.uav_pos);
+    qSwap(uav_inside, o.uav_inside);
+    str_distance.swap(o.str_distance);
+    distance_lines_pts.swap(o.distance_lines_pts);
+    distance_txt_pts.swap(o.distance_txt_pts);
+
+    target_instances.swap(o.target_instances);
+    target_lines_pts.swap(o.target_lines_pts);
+    target_labels.swap(o.target_labels);
+    rim_badges.swap(o.rim_badges);
+
+    target_ids.swap(o.target_ids);
+    target_pixels.swap(o.target_pixels);
+
+    rim_bins.swap(o.rim_bins);
+    rim_pixels.swap(o.rim_pixels);
+    rim_bin_labelled.swap(o.rim_bin_labelled);
+}
+
+GLPoint2f FramePacket::target_pos(double radius, double distance, double direction, bool &inside)
+{
+    inside = (distance < radius);
+
+    float ratio = static_cast<float>(distance / radius);
+    float r = circle_f * (ratio < 1 ? ratio : 1);
+    float x = r * static_cast<float>(cos(direction + PI/2));
+    float y = r * static_cast<float>(sin(direction + PI/2));
+
+    return GLPoint2f(x, y);
+}
+
+DistanceMark FramePacket::distance_mark(const GLPoint2f &pos, bool inside)
+{
+    static const float h_line_w = 0.4f;
+    static const float txt_h = 0.1f;
+
+    DistanceMark mark;
+
+    float hLineXOffset = h_line_w * (pos.x < 0 ? -1 : 1);
+    mark.uav = (inside ? pos : GLPoint2f(pos.x * 1.2f, pos.y * 1.2f));
+    mark.end = GLPoint2f(mark.uav.x + hLineXOffset, mark.uav.y);
+
+    // start at the rim of tgt, the line is drawn over the cached tgt
+    mark.start = mark.uav;
+    float len = sqrt(mark.uav.x*mark.uav.x + mark.uav.y*mark.uav.y);
+    if (len > tgt_radius)
+    {
+        mark.start = GLPoint2f(mark.uav.x * tgt_radius / len, mark.uav.y * tgt_radius / len);
+    }
+
+    if (pos.x < 0)
+    {
+        mark.txt_top_left = GLPoint2f(mark.end.x, mark.end.y + txt_h);
+        mark.txt_bottom_right = mark.uav;
+    }
+    else
+    {
+        mark.txt_top_left = GLPoint2f(mark.uav.x, mark.uav.y + txt_h);
+        mark.txt_bottom_right = mark.end;
+    }
+
+    return mark;
+}
+
+/**
+ * @brief FramePacket::distance_text
+ * "12.34m" inside, ">500m" outside, written into the storage `txt` already has
+ */
+void FramePacket::distance_text(QString &txt, double radius, double distance, bool inside)
+{
+    char buf[48];
+    int n = 0;
+
+    if (inside)
+    {
+        // rounded as `VisibleState::distance_cm`
+        const qint64 cm = qRound64(distance * 100);
+        if (cm < 0) buf[n++] = '-';
+
+        const quint64 abs = static_cast<quint64>(cm < 0 ? -cm : cm);
+        n += format_uint(buf + n, abs / 100);
+        buf[n++] = '.';
+        buf[n++] = static_cast<char>('0' + abs / 10 % 10);
+        buf[n++] = static_cast<char>('0' + abs % 10);
+    }
+    else if (radius == std::floor(radius) && radius >= 0 && radius < 1e6)
+    {
+        // the shortest form of `QString::arg(double)` for a whole number below 1e6
+        buf[n++] = '>';
+        n += format_uint(buf + n, static_cast<quint64>(radius));
+    }
+    else
+    {
+        txt = QString(">%1m").arg(radius);
+        return;
+    }
+
+    buf[n++] = 'm';
+
+    assign_latin1(txt, buf, n);
+}
+
+/**
+ * @brief FramePacket::rim_bin_count
+ * whichever of the chevron and the badge is wider in pixels, so a small ctrl gets fewer bins
+ */
+int FramePacket::rim_bin_count(const QRect &rcViewPort)
+{
+    const double halfPx = qMin(rcViewPort.width(), rcViewPort.height()) / 2.0;
+    const double binPx = qMax(rim_chevron_w * halfPx, rim_badge_w_px);
+    return static_cast<int>(2 * PI * circle_f * halfPx / binPx);
+}
+
+void FramePacket::build_uav()
+{
+    uav_pos = target_pos(radius, state.distance, state.direction, uav_inside);
+
+    auto mark = distance_mark(uav_pos, uav_inside);
+
+    distance_lines_pts[0] = mark.start;
+    distance_lines_pts[1] = mark.uav;
+    distance_lines_pts[2] = mark.end;
+
+    distance_txt_pts[0] = mark.txt_top_left;
+    distance_txt_pts[1] = mark.txt_bottom_right;
+
+    distance_text(str_distance, radius, state.distance, uav_inside);
+}
+
+/**
+ * @brief FramePacket::build_targets
+ * markers of the targets inside the radius, leader lines and labels of the labelled and the hovered ones only,
+ * the targets beyond it are left to the bins of `build_rim_markers`
+ */
+void FramePacket::build_targets(const QHash<int, PreciseLandingState> &targets, const QSet<int> &labelled, int hovered,
+                                int &labelCount)
+{
+    target_instances.clear();
+    target_lines_pts.clear();
+    target_ids.clear();
+    target_pixels.clear();
+
+    for (auto it = targets.constBegin(); it != targets.constEnd(); ++it)
+    {
+        const auto &st = it.value();
+
+        bool inside;
+        auto pos = target_pos(radius, st.distance, st.direction, inside);
+        if (!inside) continue;
+
+        target_instances.push_back(GLMarkerInstance(pos, static_cast<float>(st.uav_angle), 0));
+        target_ids.push_back(it.key());
+        target_pixels.push_back(transform.to_pixel(pos));
+
+        if (it.key() != hovered && !labelled.contains(it.key())) continue;
+
+        set_label(labelCount, pos, st.distance, true);
+    }
+}
+
+/**
+ * @brief FramePacket::build_rim_markers
+ * a chevron at the mean bearing of every occupied bin, a badge outside the rim if it holds more than one target,
+ * one label for a hovered or labelled bin, or a bin holding a hovered or labelled target
+ */
+void FramePacket::build_rim_markers(const RimClusters &rim, const QSet<int> &labelled, int hovered,
+                                    const QSet<int> &labelledBins, int hoveredBin, int &labelCount)
+{
+    rim_bins.clear();
+    rim_pixels.clear();
+
+    rim_bin_labelled.fill(false, rim.bin_count());
+    for (int id : labelled)
+    {
+        const int bin = rim.bin_of_member(id);
+        if (bin >= 0) rim_bin_labelled[bin] = true;
+    }
+    for (int bin : labelledBins)
+    {
+        if (bin >= 0 && bin < rim.bin_count()) rim_bin_labelled[bin] = true;
+    }
+
+    const int hoveredMemberBin = rim.bin_of_member(hovered);
+    if (hoveredMemberBin >= 0) rim_bin_labelled[hoveredMemberBin] = true;
+    if (hoveredBin >= 0 && hoveredBin < rim.bin_count()) rim_bin_labelled[hoveredBin] = true;
+
+    int badgeCount = 0;
+
+    for (int bin = 0; bin < rim.bin_count(); ++bin)
+    {
+        const int n = rim.count(bin);
+        if (n == 0) continue;
+
+        const double direction = rim.direction(bin);
+        const GLPoint2f pos(circle_f * static_cast<float>(cos(direction + PI/2)),
+                            circle_f * static_cast<float>(sin(direction + PI/2)));
+        target_instances.push_back(GLMarkerInstance(pos, static_cast<float>(direction), 1));
+
+        rim_bins.push_back(bin);
+        rim_pixels.push_back(transform.to_pixel(pos));
+
+        if (rim_bin_labelled.at(bin)) set_label(labelCount, pos, radius, false);
+
+        if (n == 1) continue;
+
+        if (badgeCount == rim_badges.size()) rim_badges.resize(badgeCount + 1);
+
+        auto &badge = rim_badges[badgeCount++];
+
+        char buf[20];
+        assign_latin1(badge.text, buf, format_uint(buf, static_cast<quint64>(n)));
+
+        const QPointF c = transform.to_pixel(GLPoint2f(pos.x * 1.12f, pos.y * 1.12f));
+        const QPointF d(rim_badge_w_px / 2, rim_badge_h_px / 2);
+        badge.top_left = transform.to_gl(c - d);
+        badge.bottom_right = transform.to_gl(c + d);
+    }
+
+    rim_badges.resize(badgeCount);
+}
+
+/**
+ * @brief FramePacket::set_label
+ * a leader line and a distance label at pos, into the next label `target_labels` already has if any
+ */
+void FramePacket::set_label(int &labelCount, const GLPoint2f &pos, double distance, bool inside)
+{
+    auto mark = distance_mark(pos, inside);
+    target_lines_pts << mark.start << mark.uav << mark.uav << mark.end;
+
+    if (labelCount == target_labels.size()) target_labels.resize(labelCount + 1);
+
+    auto &label = target_labels[labelCount++];
+    distance_text(label.text, radius, distance, inside);
+    label.top_left = mark.txt_top_left;
+    label.bottom_right = mark.txt_bottom_right;
+}
@@ -0,0 +1,125 @@
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QPointF>
+#include <QRect>
+
+#include "gl_utils.h"
+#include "precise_landing_state.h"
+#include "viewport_transform.h"
+#include "rim_clusters.h"
+
+
+/**
+ * @brief The DistanceMark struct
+ * leader line start -> uav -> end, and the rect of the distance text
+ */
+struct DistanceMark
+{
+    GLPoint2f   start;
+    GLPoint2f   uav;
+    GLPoint2f   end;
+    GLPoint2f   txt_top_left;
+    GLPoint2f   txt_bottom_right;
+};
+
+struct TargetLabel
+{
+    QString     text;
+    GLPoint2f   top_left;
+    GLPoint2f   bottom_right;
+};
+
+/**
+ * @brief The FrameInput struct
+ * everything a frame is built from, the containers are implicitly shared with the ctrl,
+ * so taking the input copies no fleet, the ctrl copies its fleet once if it changes it while a build holds it
+ */
+struct FrameInput
+{
+    PreciseLandingState                 state;
+    double                              radius;
+    ViewportTransform                   transform;
+    QHash<int, PreciseLandingState>     targets;
+    QSet<int>                           labelled;
+    int                                 hovered;
+    RimClusters                         rim;
+    QSet<int>                           labelled_bins;
+    int                                 hovered_bin;
+
+    FrameInput()
+        : radius(1), hovered(-1), hovered_bin(-1)
+    {}
+
+    FrameInput(const PreciseLandingState &tmpState, double tmpRadius, const ViewportTransform &tmpTransform,
+               const QHash<int, PreciseLandingState> &tmpTargets, const QSet<int> &tmpLabelled, int tmpHovered,
+               const RimClusters &tmpRim, const QSet<int> &tmpLabelledBins, int tmpHoveredBin)
+        : state(tmpState), radius(tmpRadius), transform(tmpTransform), targets(tmpTargets), labelled(tmpLabelled),
+          hovered(tmpHovered), rim(tmpRim), labelled_bins(tmpLabelledBins), hovered_bin(tmpHoveredBin)
+    {}
+};
+
+/**
+ * @brief The FramePacket struct
+ * the geometry of one frame in gl coordinates, all the ctrl draws besides the static layer and the trail,
+ * built on the gui thread or on a worker, never changed once handed over,
+ * a packet is built again into the storage it already has
+ */
+struct FramePacket
+{
+    PreciseLandingState     state;
+    double                  radius;
+    ViewportTransform       transform;
+
+    GLPoint2f               uav_pos;
+    bool                    uav_inside;
+    QString                 str_distance;
+    QVector<GLPoint2f>      distance_lines_pts;     // start, uav, end
+    QVector<GLPoint2f>      distance_txt_pts;       // top left, bottom right
+
+    // markers of the targets inside the radius, then one chevron per occupied bearing bin
+    QVector<GLMarkerInstance>   target_instances;
+    QVector<GLPoint2f>          target_lines_pts;
+    QVector<TargetLabel>        target_labels;
+    QVector<TargetLabel>        rim_badges;
+
+    // the targets inside the radius in pixels, for picking
+    QVector<int>            target_ids;
+    QVector<QPointF>        target_pixels;
+
+    // the occupied bins and their chevrons in pixels, for picking
+    QVector<int>            rim_bins;
+    QVector<QPointF>        rim_pixels;
+    QVector<bool>           rim_bin_labelled;       // per bin, scratch of `build_rim_markers`
+
+    FramePacket();
+
+    void build(const FrameInput &in);
+    void build(const PreciseLandingState &st, double r, const ViewportTransform &vt,
+               const QHash<int, PreciseLandingState> &targets, const QSet<int> &labelled, int hovered,
+               const RimClusters &rim, const QSet<int> &labelledBins, int hoveredBin);
+
+    void swap(FramePacket &o);
+
+    // targets beyond `radius` are clamped to the circle
+    static GLPoint2f target_pos(double radius, double distance, double direction, bool &inside);
+    static DistanceMark distance_mark(const GLPoint2f &pos, bool inside);
+    static void distance_text(QString &txt, double radius, double distance, bool inside);
+
+    // bearing bins of a viewport, a bin is as wide on the rim as a chevron or a badge
+    static int rim_bin_count(const QRect &rcViewPort);
+
+private:
+    void build_uav();
+    void build_targets(const QHash<int, PreciseLandingState> &targets, const QSet<int> &labelled, int hovered,
+                       int &labelCount);
+    void build_rim_markers(const RimClusters &rim, const QSet<int> &labelled, int hovered,
+                           const QSet<int> &labelledBins, int hoveredBin, int &labelCount);
+    void set_label(int &labelCount, const GLPoint2f &pos, double distance, bool inside);
+};
+
+#endif // FRAME_PACKET_H
@@ -0,0 +1,147 @@
+#include "frame_pipeline.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <QMutexLocker>
+
+#include <utility>
+
+
+/**
+ * @brief The FramePipeline::Task class
+ * started again for every run of builds, never deleted by the pool
+ */
+class FramePipeline::Task : public QRunnable
+{
+public:
+    explicit Task(FramePipeline *pipeline)
+        : _pipeline(pipeline)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        _pipeline->run();
+    }
+
+private:
+    FramePipeline   *_pipeline;
+};
+
+
+FramePipeline::FramePipeline(const std::function<void()> &ready)
+    : _has_pending(false), _running(false), _stopping(false), _built_count(0), _ready(ready)
+{
+    for (auto &packet : _packets)
+    {
+        _free_packets.push(&packet);
+    }
+
+    _task = new Task(this);
+}
+
+/**
+ * @brief FramePipeline::~FramePipeline
+ * the waiting input is dropped, the running build is waited for
+ */
+FramePipeline::~FramePipeline()
+{
+    {
+        QMutexLocker locker(&_mtx);
+        _stopping = true;
+        while (_running)
+        {
+            _idle.wait(&_mtx);
+        }
+    }
+
+    delete _task;
+}
+
+/**
+ * @brief FramePipeline::submit
+ * the input only shares the containers of the caller, nothing is copied deeply here
+ */
+void FramePipeline::submit(const FrameInput &in)
+{
+    QMutexLocker locker(&_mtx);
+
+    _pending = in;
+    _has_pending = true;
+
+    if (!_running) start();
+}
+
+bool FramePipeline::take(FramePacket &frame)
+{
+    FramePacket *newest = nullptr;
+    FramePacket *packet = nullptr;
+    while (_ready_packets.pop(packet))
+    {
+        if (newest) _free_packets.push(newest);
+        newest = packet;
+    }
+
+    if (!newest) return false;
+
+    // the packet keeps the storage of the last frame for a later build
+    frame.swap(*newest);
+    _free_packets.push(newest);
+
+    // a build that stopped for want of a free packet
+    QMutexLocker locker(&_mtx);
+    if (_has_pending && !_running) start();
+
+    return true;
+}
+
+qint64 FramePipeline::built_count() const
+{
+    return _built_count.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief FramePipeline::run
+ * build until no input waits, the input is moved out under the lock and built without it
+ */
+void FramePipeline::run()
+{
+    for (;;)
+    {
+        FramePacket *packet = nullptr;
+
+        // the containers shared with the ctrl are released before the gui thread hears of the packet
+        {
+            FrameInput in;
+            {
+                QMutexLocker locker(&_mtx);
+                if (_stopping || !_has_pending || !_free_packets.pop(packet))
+                {
+                    _running = false;
+                    _idle.wakeAll();
+                    return;
+                }
+
+                std::swap(in, _pending);
+                _has_pending = false;
+            }
+
+            packet->build(in);
+        }
+
+        // there are as many slots as packets
+        _ready_packets.push(packet);
+
+        // counted after the gui thread is told, whoever sees the count finds the packet announced
+        _ready();
+        _built_count.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// `_mtx` is held
+void FramePipeline::start()
+{
+    _running = true;
+    QThreadPool::globalInstance()->start(_task);
+}
@@ -0,0 +1,66 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+
+#include "frame_packet.h"
+#include "spsc_queue.h"
+
+
+/**
+ * @brief The FramePipeline class
+ * frame packets built on the global thread pool and handed to the gui thread through a lock free queue,
+ * at most one build of a pipeline runs at a time, an input submitted meanwhile replaces the one still waiting,
+ * the packets circulate between a free and a ready queue, none is allocated after the first builds
+ */
+class FramePipeline
+{
+public:
+    // ready: called on the worker once a packet is queued, the gui thread should `take` it soon
+    explicit FramePipeline(const std::function<void()> &ready);
+    ~FramePipeline();
+
+    // gui thread
+    void submit(const FrameInput &in);
+
+    // gui thread, the newest packet is swapped into `frame`, the older ones are recycled, false if none is ready
+    bool take(FramePacket &frame);
+
+    qint64 built_count() const;
+
+private:
+    class Task;
+
+    void run();
+    void start();
+
+private:
+    static const int packet_count = 3;
+
+    QMutex          _mtx;
+    QWaitCondition  _idle;
+
+    // guarded by `_mtx`
+    FrameInput      _pending;
+    bool            _has_pending;
+    bool            _running;
+    bool            _stopping;
+
+    FramePacket     _packets[packet_count];
+
+    // every packet is in one of them, or being built, or being taken
+    SpscQueue<FramePacket *, packet_count>  _free_packets;      // gui -> worker
+    SpscQueue<FramePacket *, packet_count>  _ready_packets;     // worker -> gui
+
+    std::atomic<qint64>     _built_count;
+
+    std::function<void()>   _ready;
+    Task                    *_task;
+
+};
+
+#endif // FRAME_PIPELINE_H
@@ -0,0 +1,253 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+
+
+static const int no_stage = -1;
+
+static const char *stage_names[FrameProfiler::StageCount] =
+{
+    "static", "bg", "axis", "tgt", "trail", "distance", "targets", "uav", "text"
+};
+
+
+FrameProfiler::FrameProfiler()
+    : _gl(nullptr), _enabled(false), _in_frame(false), _gpu_frame(false),
+      _stage_begin_ns(0), _cur_stage(no_stage), _stack_size(0),
+      _pending_begin(0), _pending_count(0)
+{
+    _timer.start();
+
+    _cpu_window.samples.resize(window_size * StageCount);
+    _gpu_window.samples.resize(window_size * StageCount);
+    _vec_scratch.reserve(window_size);
+
+    reset();
+}
+
+const char *FrameProfiler::stage_name(int stage)
+{
+    if (stage < 0 || stage >= StageCount) return "";
+
+    return stage_names[stage];
+}
+
+void FrameProfiler::set_gl(GLFuncUtils *gl)
+{
+    _gl = gl;
+}
+
+/**
+ * @brief FrameProfiler::release_gl
+ * forget the pending queries, the context must be current
+ */
+void FrameProfiler::release_gl()
+{
+    while (_pending_count > 0)
+    {
+        drop_pending_frame();
+    }
+
+    if (_gl)
+    {
+        for (const auto &rec : _vec_cur_queries)
+        {
+            _gl->recycle_time_query(rec.query);
+        }
+    }
+    _vec_cur_queries.clear();
+}
+
+void FrameProfiler::set_enabled(bool b)
+{
+    if (b == _enabled) return;
+
+    _enabled = b;
+    reset();
+}
+
+bool FrameProfiler::is_enabled() const
+{
+    return _enabled;
+}
+
+/**
+ * @brief FrameProfiler::reset
+ * clear the windows, the pending queries are still collected, their frames are just not counted
+ */
+void FrameProfiler::reset()
+{
+    _cpu_window.count = 0;
+    _cpu_window.next = 0;
+    _gpu_window.count = 0;
+    _gpu_window.next = 0;
+}
+
+void FrameProfiler::begin_frame(bool gpu)
+{
+    if (!_enabled) return;
+
+    _in_frame = true;
+    _gpu_frame = (gpu && _gl);
+    _cur_stage = no_stage;
+    _stack_size = 0;
+
+    std::fill(_cpu_row, _cpu_row + StageCount, 0.0);
+    _vec_cur_queries.clear();
+}
+
+void FrameProfiler::end_frame()
+{
+    if (!_enabled || !_in_frame) return;
+
+    switch_stage(no_stage);
+    _in_frame = false;
+
+    push_row(_cpu_window, _cpu_row);
+
+    if (!_gpu_frame) return;
+
+    // oldest frames first, none of them is waited for
+    collect_gpu_frames();
+    if (_pending_count == max_pending_frames) drop_pending_frame();
+
+    const int idx = (_pending_begin + _pending_count) % max_pending_frames;
+    _pending_frames[idx].swap(_vec_cur_queries);
+    ++_pending_count;
+}
+
+void FrameProfiler::push_stage(Stage s)
+{
+    if (!_enabled || !_in_frame) return;
+
+    if (_stack_size < max_depth)
+    {
+        _stack[_stack_size] = s;
+        switch_stage(s);
+    }
+
+    ++_stack_size;
+}
+
+void FrameProfiler::pop_stage()
+{
+    if (!_enabled || !_in_frame || _stack_size == 0) return;
+
+    --_stack_size;
+    if (_stack_size >= max_depth) return;
+
+    switch_stage(_stack_size > 0 ? _stack[_stack_size - 1] : no_stage);
+}
+
+double FrameProfiler::cpu_percentile(int stage, double p) const
+{
+    return percentile(_cpu_window, stage, p);
+}
+
+double FrameProfiler::gpu_percentile(int stage, double p) const
+{
+    return percentile(_gpu_window, stage, p);
+}
+
+int FrameProfiler::cpu_frame_count() const
+{
+    return _cpu_window.count;
+}
+
+int FrameProfiler::gpu_frame_count() const
+{
+    return _gpu_window.count;
+}
+
+/**
+ * @brief FrameProfiler::switch_stage
+ * close the running stage and start the next one, timer queries can not nest,
+ * so a nested stage splits the query of its outer stage in two
+ */
+void FrameProfiler::switch_stage(int stage)
+{
+    const qint64 now = _timer.nsecsElapsed();
+
+    if (_cur_stage != no_stage)
+    {
+        _cpu_row[_cur_stage] += (now - _stage_begin_ns) / 1000.0;
+        if (_gpu_frame) _gl->end_time_query();
+    }
+
+    _cur_stage = stage;
+    _stage_begin_ns = now;
+
+    if (_cur_stage != no_stage && _gpu_frame)
+    {
+        QueryRecord rec;
+        rec.query = _gl->begin_time_query();
+        rec.stage = _cur_stage;
+        _vec_cur_queries.push_back(rec);
+    }
+}
+
+void FrameProfiler::collect_gpu_frames()
+{
+    double row[StageCount];
+
+    while (_pending_count > 0)
+    {
+        auto &vecQueries = _pending_frames[_pending_begin];
+        std::fill(row, row + StageCount, 0.0);
+
+        bool ready = true;
+        for (const auto &rec : vecQueries)
+        {
+            qint64 ns = 0;
+            if (!_gl->time_query_result(rec.query, ns))
+            {
+                ready = false;
+                break;
+            }
+
+            row[rec.stage] += ns / 1000.0;
+        }
+
+        if (!ready) return;
+
+        push_row(_gpu_window, row);
+        drop_pending_frame();
+    }
+}
+
+void FrameProfiler::drop_pending_frame()
+{
+    auto &vecQueries = _pending_frames[_pending_begin];
+    for (const auto &rec : vecQueries)
+    {
+        _gl->recycle_time_query(rec.query);
+    }
+    vecQueries.clear();
+
+    _pending_begin = (_pending_begin + 1) % max_pending_frames;
+    --_pending_count;
+}
+
+void FrameProfiler::push_row(Window &w, const double *row)
+{
+    std::copy(row, row + StageCount, w.samples.begin() + w.next * StageCount);
+
+    w.next = (w.next + 1) % window_size;
+    w.count = qMin(w.count + 1, static_cast<int>(window_size));
+}
+
+double FrameProfiler::percentile(const Window &w, int stage, double p) const
+{
+    if (w.count == 0 || stage < 0 || stage >= StageCount) return 0;
+
+    _vec_scratch.resize(w.count);
+    for (int i = 0; i < w.count; ++i)
+    {
+        _vec_scratch[i] = w.samples.at(i * StageCount + stage);
+    }
+
+    const int idx = qBound(0, static_cast<int>(p * (w.count - 1) + 0.5), w.count - 1);
+    std::nth_element(_vec_scratch.begin(), _vec_scratch.begin() + idx, _vec_scratch.end());
+
+    return _vec_scratch.at(idx);
+}
@@ -0,0 +1,116 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "gl_utils.h"
+
+
+/**
+ * @brief The FrameProfiler class
+ * cpu and gpu time of every stage of a frame, kept for a rolling window of frames,
+ * stages nest, the time of an inner stage is not counted for the outer one,
+ * the gpu time comes from timer queries read some frames later, a frame whose queries are still pending
+ * when `max_pending_frames` newer frames are waiting is dropped instead of stalling
+ */
+class FrameProfiler
+{
+public:
+    enum Stage
+    {
+        StageStaticLayer,   // composite of the cached bg, axis and tgt
+        StageBg,
+        StageAxis,
+        StageTgt,
+        StageTrail,
+        StageDistanceMark,
+        StageTargets,
+        StageUav,
+        StageText,
+        StageCount
+    };
+
+    static const int window_size = 240;
+    static const int max_pending_frames = 4;
+    static const int max_depth = 8;
+
+public:
+    FrameProfiler();
+
+    static const char *stage_name(int stage);
+
+    // gl: the queries are issued through it, the context must be current between `begin_frame` and `end_frame`
+    void set_gl(GLFuncUtils *gl);
+    void release_gl();
+
+    void set_enabled(bool b);
+    bool is_enabled() const;
+    void reset();
+
+    // gpu: false times the cpu only, stages outside a frame are ignored
+    void begin_frame(bool gpu = true);
+    void end_frame();
+
+    void push_stage(Stage s);
+    void pop_stage();
+
+    // microsecond, p of range [0, 1]
+    double cpu_percentile(int stage, double p) const;
+    double gpu_percentile(int stage, double p) const;
+    int cpu_frame_count() const;
+    int gpu_frame_count() const;
+
+private:
+    struct QueryRecord
+    {
+        GLuint  query;
+        int     stage;
+    };
+
+    // the last `window_size` frames, one row of stage times per frame
+    struct Window
+    {
+        QVector<double>     samples;
+        int                 count;
+        int                 next;
+    };
+
+private:
+    void switch_stage(int stage);
+    void collect_gpu_frames();
+    void drop_pending_frame();
+
+    void push_row(Window &w, const double *row);
+    double percentile(const Window &w, int stage, double p) const;
+
+private:
+    GLFuncUtils     *_gl;
+    bool            _enabled;
+
+    bool            _in_frame;
+    bool            _gpu_frame;
+    QElapsedTimer   _timer;
+    qint64          _stage_begin_ns;
+    int             _cur_stage;
+
+    Stage           _stack[max_depth];
+    int             _stack_size;
+
+    double          _cpu_row[StageCount];
+
+    QVector<QueryRecord>    _vec_cur_queries;
+
+    // oldest first
+    QVector<QueryRecord>    _pending_frames[max_pending_frames];
+    int             _pending_begin;
+    int             _pending_count;
+
+    Window          _cpu_window;
+    Window          _gpu_window;
+
+    mutable QVector<double>     _vec_scratch;
+
+};
+
+#endif // FRAME_PROFILER_H
@@ -0,0 +1,405 @@
+#include "geodesy.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GEODESY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+static const double PI = 3.14159265358979323846;
+static const double two_pi = 2 * PI;
+static const double deg_2_rad = PI / 180;
+
+// mean earth radius, meter
+static const double earth_radius = 6371008.8;
+
+// WGS84 ellipsoid
+static const double wgs84_a = 6378137.0;
+static const double wgs84_f = 1 / 298.257223563;
+static const double wgs84_b = wgs84_a * (1 - wgs84_f);
+
+static const int vincenty_max_iterations = 200;
+static const double vincenty_epsilon = 1e-12;
+
+
+static inline double wrap_pi(double a)
+{
+    return a - two_pi * std::floor(a / two_pi + 0.5);
+}
+
+static inline double wrap_two_pi(double a)
+{
+    return a + two_pi * (a < 0);
+}
+
+#ifdef GEODESY_USE_SSE2
+// PI/2 in three parts, the reduced angle keeps its bits for a few turns
+static const double pio2_1 = 1.57079625129699707031E0;
+static const double pio2_2 = 7.54978941586159635335E-8;
+static const double pio2_3 = 5.39030285815811905290E-15;
+
+// sin and cos of |r| <= PI/4, cephes
+static const double sin_coef[] =
+{
+    1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+    -1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1
+};
+static const double cos_coef[] =
+{
+    -1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7,
+    2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2
+};
+
+// atan of |x| <= 0.66 as x + x*z*P(z)/Q(z), cephes
+static const double atan_p[] =
+{
+    -8.750608600031904122785E-1, -1.615753718733365076637E1, -7.500855792314704667340E1,
+    -1.228866684490136173410E2, -6.485021904942025371773E1
+};
+static const double atan_q[] =
+{
+    1, 2.485846490142306297962E1, 1.650270098316988542046E2, 4.328810604912902668951E2,
+    4.853903996359136964868E2, 1.945506571482613964425E2
+};
+static const double tan_3pi_8 = 2.41421356237309504880;
+static const double atan_more_bits = 6.123233995736765886130E-17;
+
+template <int N>
+static inline __m128d poly_pd(__m128d z, const double (&c)[N])
+{
+    __m128d p = _mm_set1_pd(c[0]);
+    for (int k = 1; k < N; ++k)
+    {
+        p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(c[k]));
+    }
+
+    return p;
+}
+
+// mask ? a : b
+static inline __m128d select_pd(__m128d mask, __m128d a, __m128d b)
+{
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// lanes whose int32 quadrant has `bit` set, the int32 of a lane is spread over its 64 bits
+static inline __m128d quadrant_mask(__m128i q64, int bit)
+{
+    const __m128i b = _mm_set1_epi32(bit);
+    return _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(q64, b), b));
+}
+
+static inline __m128d round_pd(__m128d a)
+{
+    return _mm_cvtepi32_pd(_mm_cvtpd_epi32(a));
+}
+
+static inline __m128d wrap_pi_pd(__m128d a)
+{
+    return _mm_sub_pd(a, _mm_mul_pd(_mm_set1_pd(two_pi), round_pd(_mm_mul_pd(a, _mm_set1_pd(1 / two_pi)))));
+}
+
+static inline __m128d wrap_two_pi_pd(__m128d a)
+{
+    return select_pd(_mm_cmplt_pd(a, _mm_setzero_pd()), _mm_add_pd(a, _mm_set1_pd(two_pi)), a);
+}
+
+/**
+ * @brief sincos_pd
+ * x = q*PI/2 + r, the quadrant q picks and negates the polynomials of r, |x| within a few turns
+ */
+static inline void sincos_pd(__m128d x, __m128d &s, __m128d &c)
+{
+    const __m128i qi = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(2 / PI)));
+    const __m128d q = _mm_cvtepi32_pd(qi);
+
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(q, _mm_set1_pd(pio2_1)));
+    r = _mm_sub_pd(r, _mm_mul_pd(q, _mm_set1_pd(pio2_2)));
+    r = _mm_sub_pd(r, _mm_mul_pd(q, _mm_set1_pd(pio2_3)));
+
+    const __m128d z = _mm_mul_pd(r, r);
+    const __m128d sr = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), poly_pd(z, sin_coef)));
+    const __m128d cr = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1), _mm_mul_pd(_mm_set1_pd(0.5), z)),
+                                  _mm_mul_pd(_mm_mul_pd(z, z), poly_pd(z, cos_coef)));
+
+    // sin: sr, cr, -sr, -cr and cos: cr, -sr, -cr, sr for q & 3
+    const __m128i q64 = _mm_shuffle_epi32(qi, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128i q64Next = _mm_add_epi32(q64, _mm_set1_epi32(1));
+    const __m128d swap = quadrant_mask(q64, 1);
+    const __m128d sign = _mm_set1_pd(-0.0);
+
+    s = _mm_xor_pd(select_pd(swap, cr, sr), _mm_and_pd(quadrant_mask(q64, 2), sign));
+    c = _mm_xor_pd(select_pd(swap, sr, cr), _mm_and_pd(quadrant_mask(q64Next, 2), sign));
+}
+
+/**
+ * @brief atan2_pd
+ * atan of |y|/|x| reduced to |t| <= 0.66 as cephes does, then put in the quadrant of (x, y),
+ * atan2(0, 0) is 0
+ */
+static inline __m128d atan2_pd(__m128d y, __m128d x)
+{
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1);
+
+    const __m128d ax = _mm_andnot_pd(sign, x);
+    const __m128d ay = _mm_andnot_pd(sign, y);
+    const __m128d origin = _mm_and_pd(_mm_cmpeq_pd(ax, zero), _mm_cmpeq_pd(ay, zero));
+    const __m128d t = _mm_andnot_pd(origin, _mm_div_pd(ay, ax));
+
+    // -1/t, (t-1)/(t+1) or t, in one division
+    const __m128d big = _mm_cmpgt_pd(t, _mm_set1_pd(tan_3pi_8));
+    const __m128d mid = _mm_andnot_pd(big, _mm_cmpgt_pd(t, _mm_set1_pd(0.66)));
+    const __m128d num = select_pd(big, _mm_set1_pd(-1), select_pd(mid, _mm_sub_pd(t, one), t));
+    const __m128d den = select_pd(big, t, select_pd(mid, _mm_add_pd(t, one), one));
+    const __m128d r = _mm_div_pd(num, den);
+
+    const __m128d base = select_pd(big, _mm_set1_pd(PI / 2), _mm_and_pd(mid, _mm_set1_pd(PI / 4)));
+    const __m128d more = select_pd(big, _mm_set1_pd(atan_more_bits), _mm_and_pd(mid, _mm_set1_pd(0.5 * atan_more_bits)));
+
+    const __m128d z = _mm_mul_pd(r, r);
+    const __m128d pq = _mm_div_pd(poly_pd(z, atan_p), poly_pd(z, atan_q));
+    const __m128d a = _mm_add_pd(base, _mm_add_pd(_mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), pq)), more));
+
+    const __m128d left = _mm_cmplt_pd(x, zero);
+    const __m128d turned = select_pd(left, _mm_sub_pd(_mm_set1_pd(PI), a), a);
+
+    return _mm_or_pd(turned, _mm_and_pd(y, sign));
+}
+#endif
+
+
+Geodesy::Geodesy(Method m)
+    : _method(m)
+{
+    set_origin(0, 0);
+}
+
+void Geodesy::set_method(Method m)
+{
+    _method = m;
+}
+
+Geodesy::Method Geodesy::method() const
+{
+    return _method;
+}
+
+void Geodesy::set_origin(double lon, double lat)
+{
+    _lon = lon;
+    _lat = lat;
+
+    _lon_rad = lon * deg_2_rad;
+    _lat_rad = lat * deg_2_rad;
+    _sin_lat = std::sin(_lat_rad);
+    _cos_lat = std::cos(_lat_rad);
+
+    const double u1 = std::atan((1 - wgs84_f) * std::tan(_lat_rad));
+    _sin_u1 = std::sin(u1);
+    _cos_u1 = std::cos(u1);
+}
+
+double Geodesy::origin_lon() const
+{
+    return _lon;
+}
+
+double Geodesy::origin_lat() const
+{
+    return _lat;
+}
+
+RangeBearing Geodesy::range_bearing(double lon, double lat) const
+{
+    RangeBearing rb;
+    range_bearing(&lon, &lat, 1, &rb.distance, &rb.bearing);
+
+    return rb;
+}
+
+void Geodesy::range_bearing(const double *lons, const double *lats, int count, double *distances, double *bearings) const
+{
+    switch (_method)
+    {
+    case Equirectangular:
+        equirectangular(lons, lats, count, distances, bearings);
+        break;
+    case Haversine:
+        haversine(lons, lats, count, distances, bearings);
+        break;
+    case Vincenty:
+        for (int i = 0; i < count; ++i)
+        {
+            auto rb = vincenty(lons[i], lats[i]);
+            distances[i] = rb.distance;
+            bearings[i] = rb.bearing;
+        }
+        break;
+    }
+}
+
+void Geodesy::equirectangular(const double *lons, const double *lats, int count, double *distances, double *bearings) const
+{
+    const double kx = earth_radius * _cos_lat;
+    const double ky = earth_radius;
+
+    int i = 0;
+
+#ifdef GEODESY_USE_SSE2
+    const __m128d d2r = _mm_set1_pd(deg_2_rad);
+    const __m128d lon0 = _mm_set1_pd(_lon_rad);
+    const __m128d lat0 = _mm_set1_pd(_lat_rad);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128d dx = _mm_mul_pd(_mm_set1_pd(kx), wrap_pi_pd(_mm_sub_pd(_mm_mul_pd(_mm_loadu_pd(lons + i), d2r), lon0)));
+        const __m128d dy = _mm_mul_pd(_mm_set1_pd(ky), _mm_sub_pd(_mm_mul_pd(_mm_loadu_pd(lats + i), d2r), lat0));
+
+        _mm_storeu_pd(distances + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+        _mm_storeu_pd(bearings + i, wrap_two_pi_pd(atan2_pd(dx, dy)));
+    }
+#endif
+
+    // the tail, and a single point
+    for (; i < count; ++i)
+    {
+        const double dx = kx * wrap_pi(lons[i] * deg_2_rad - _lon_rad);
+        const double dy = ky * (lats[i] * deg_2_rad - _lat_rad);
+
+        distances[i] = std::sqrt(dx*dx + dy*dy);
+        bearings[i] = wrap_two_pi(std::atan2(dx, dy));
+    }
+}
+
+void Geodesy::haversine(const double *lons, const double *lats, int count, double *distances, double *bearings) const
+{
+    int i = 0;
+
+#ifdef GEODESY_USE_SSE2
+    const __m128d d2r = _mm_set1_pd(deg_2_rad);
+    const __m128d lon0 = _mm_set1_pd(_lon_rad);
+    const __m128d lat0 = _mm_set1_pd(_lat_rad);
+    const __m128d sinLat0 = _mm_set1_pd(_sin_lat);
+    const __m128d cosLat0 = _mm_set1_pd(_cos_lat);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d one = _mm_set1_pd(1);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128d lat = _mm_mul_pd(_mm_loadu_pd(lats + i), d2r);
+        const __m128d dLon = wrap_pi_pd(_mm_sub_pd(_mm_mul_pd(_mm_loadu_pd(lons + i), d2r), lon0));
+
+        __m128d sinLat, cosLat, sinHalfLat, cosHalfLat, sinHalfLon, cosHalfLon, sinDLon, cosDLon;
+        sincos_pd(lat, sinLat, cosLat);
+        sincos_pd(_mm_mul_pd(_mm_sub_pd(lat, lat0), half), sinHalfLat, cosHalfLat);
+        sincos_pd(_mm_mul_pd(dLon, half), sinHalfLon, cosHalfLon);
+        sincos_pd(dLon, sinDLon, cosDLon);
+
+        __m128d a = _mm_add_pd(_mm_mul_pd(sinHalfLat, sinHalfLat),
+                               _mm_mul_pd(_mm_mul_pd(cosLat0, cosLat), _mm_mul_pd(sinHalfLon, sinHalfLon)));
+        a = _mm_min_pd(a, one);
+
+        const __m128d c = atan2_pd(_mm_sqrt_pd(a), _mm_sqrt_pd(_mm_sub_pd(one, a)));
+        _mm_storeu_pd(distances + i, _mm_mul_pd(_mm_set1_pd(2 * earth_radius), c));
+
+        const __m128d y = _mm_mul_pd(sinDLon, cosLat);
+        const __m128d x = _mm_sub_pd(_mm_mul_pd(cosLat0, sinLat), _mm_mul_pd(_mm_mul_pd(sinLat0, cosLat), cosDLon));
+        _mm_storeu_pd(bearings + i, wrap_two_pi_pd(atan2_pd(y, x)));
+    }
+#endif
+
+    // the tail, and a single point
+    for (; i < count; ++i)
+    {
+        const double lat = lats[i] * deg_2_rad;
+        const double dLon = wrap_pi(lons[i] * deg_2_rad - _lon_rad);
+        const double sinLat = std::sin(lat);
+        const double cosLat = std::cos(lat);
+        const double sinHalfLat = std::sin((lat - _lat_rad) / 2);
+        const double sinHalfLon = std::sin(dLon / 2);
+
+        double a = sinHalfLat*sinHalfLat + _cos_lat*cosLat*sinHalfLon*sinHalfLon;
+        a = std::fmin(a, 1.0);
+
+        distances[i] = 2 * earth_radius * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+
+        const double y = std::sin(dLon) * cosLat;
+        const double x = _cos_lat*sinLat - _sin_lat*cosLat*std::cos(dLon);
+        bearings[i] = wrap_two_pi(std::atan2(y, x));
+    }
+}
+
+/**
+ * @brief Geodesy::vincenty
+ * inverse problem on the WGS84 ellipsoid
+ */
+RangeBearing Geodesy::vincenty(double lon, double lat) const
+{
+    const double L = wrap_pi(lon * deg_2_rad - _lon_rad);
+    const double u2 = std::atan((1 - wgs84_f) * std::tan(lat * deg_2_rad));
+    const double sinU2 = std::sin(u2);
+    const double cosU2 = std::cos(u2);
+
+    double lambda = L;
+    double sinLambda = 0, cosLambda = 0;
+    double sinSigma = 0, cosSigma = 0, sigma = 0;
+    double cosSqAlpha = 0, cos2SigmaM = 0;
+
+    bool converged = false;
+    for (int i = 0; i < vincenty_max_iterations; ++i)
+    {
+        sinLambda = std::sin(lambda);
+        cosLambda = std::cos(lambda);
+
+        const double t1 = cosU2 * sinLambda;
+        const double t2 = _cos_u1*sinU2 - _sin_u1*cosU2*cosLambda;
+        sinSigma = std::sqrt(t1*t1 + t2*t2);
+
+        // coincident points
+        if (sinSigma == 0) return RangeBearing(0, 0);
+
+        cosSigma = _sin_u1*sinU2 + _cos_u1*cosU2*cosLambda;
+        sigma = std::atan2(sinSigma, cosSigma);
+
+        const double sinAlpha = _cos_u1 * cosU2 * sinLambda / sinSigma;
+        cosSqAlpha = 1 - sinAlpha*sinAlpha;
+
+        // equatorial line
+        cos2SigmaM = (cosSqAlpha != 0 ? cosSigma - 2*_sin_u1*sinU2/cosSqAlpha : 0);
+
+        const double C = wgs84_f / 16 * cosSqAlpha * (4 + wgs84_f*(4 - 3*cosSqAlpha));
+        const double lambdaPrev = lambda;
+        lambda = L + (1 - C) * wgs84_f * sinAlpha
+                * (sigma + C*sinSigma*(cos2SigmaM + C*cosSigma*(-1 + 2*cos2SigmaM*cos2SigmaM)));
+
+        if (std::fabs(lambda - lambdaPrev) < vincenty_epsilon)
+        {
+            converged = true;
+            break;
+        }
+    }
+
+    // nearly antipodal, the series does not converge
+    if (!converged)
+    {
+        RangeBearing rb;
+        haversine(&lon, &lat, 1, &rb.distance, &rb.bearing);
+        return rb;
+    }
+
+    const double uSq = cosSqAlpha * (wgs84_a*wgs84_a - wgs84_b*wgs84_b) / (wgs84_b*wgs84_b);
+    const double A = 1 + uSq/16384 * (4096 + uSq*(-768 + uSq*(320 - 175*uSq)));
+    const double B = uSq/1024 * (256 + uSq*(-128 + uSq*(74 - 47*uSq)));
+    const double deltaSigma = B * sinSigma
+            * (cos2SigmaM + B/4*(cosSigma*(-1 + 2*cos2SigmaM*cos2SigmaM)
+                                 - B/6*cos2SigmaM*(-3 + 4*sinSigma*sinSigma)*(-3 + 4*cos2SigmaM*cos2SigmaM)));
+
+    const double distance = wgs84_b * A * (sigma - deltaSigma);
+    const double bearing = std::atan2(cosU2*sinLambda, _cos_u1*sinU2 - _sin_u1*cosU2*cosLambda);
+
+    return RangeBearing(distance, wrap_two_pi(bearing));
+}
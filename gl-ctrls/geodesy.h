@@ -0,0 +1,77 @@
+#ifndef GEODESY_H
+#define GEODESY_H
+
+
+/**
+ * @brief The RangeBearing struct
+ * distance: meter
+ * bearing: radian, clockwise from the north, range of [0, 2*PI)
+ */
+struct RangeBearing
+{
+    double  distance;
+    double  bearing;
+
+    RangeBearing(double tmpDistance = 0, double tmpBearing = 0)
+        : distance(tmpDistance), bearing(tmpBearing)
+    {}
+};
+
+/**
+ * @brief The Geodesy class
+ * range and bearing from one origin (the platform) to many lon/lat points (the uavs),
+ * the trigonometry of the origin is computed once per `set_origin`
+ * Equirectangular: local tangent plane, for short ranges only
+ * Haversine: great circle on the mean sphere
+ * Vincenty: WGS84 ellipsoid, falls back to Haversine near antipodes
+ */
+class Geodesy
+{
+public:
+    enum Method
+    {
+        Equirectangular,
+        Haversine,
+        Vincenty
+    };
+
+public:
+    Geodesy(Method m = Haversine);
+
+    void set_method(Method m);
+    Method method() const;
+
+    // degree
+    void set_origin(double lon, double lat);
+    double origin_lon() const;
+    double origin_lat() const;
+
+    RangeBearing range_bearing(double lon, double lat) const;
+
+    // structure of arrays, Equirectangular and Haversine take two points a step with SSE2
+    void range_bearing(const double *lons, const double *lats, int count, double *distances, double *bearings) const;
+
+private:
+    void equirectangular(const double *lons, const double *lats, int count, double *distances, double *bearings) const;
+    void haversine(const double *lons, const double *lats, int count, double *distances, double *bearings) const;
+    RangeBearing vincenty(double lon, double lat) const;
+
+private:
+    Method  _method;
+
+    double  _lon;
+    double  _lat;
+
+    // origin in radian, and its trigonometry
+    double  _lon_rad;
+    double  _lat_rad;
+    double  _sin_lat;
+    double  _cos_lat;
+
+    // reduced latitude of the origin on the ellipsoid
+    double  _sin_u1;
+    double  _cos_u1;
+
+};
+
+#endif // GEODESY_H
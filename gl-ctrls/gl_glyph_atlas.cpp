@@ -0,0 +1,213 @@
+#include "gl_glyph_atlas.h"
+
+#include <QPainter>
+
+
+static const int atlas_width = 256;
+static const int glyph_padding = 2;
+static const ushort first_ascii = 32;
+static const ushort last_ascii = 126;
+
+
+GLGlyphFont::GLGlyphFont(const QFont &f)
+    : _font(f), _fm(f), _texture(nullptr), _dirty(true), _pen_x(0), _pen_y(0)
+{
+    const int cellH = _fm.height() + 2*glyph_padding;
+    _img = QImage(atlas_width, cellH * 4, QImage::Format_ARGB32_Premultiplied);
+    _img.fill(Qt::transparent);
+
+    for (ushort c = first_ascii; c <= last_ascii; ++c)
+    {
+        add_glyph(QChar(c));
+    }
+}
+
+GLGlyphFont::~GLGlyphFont()
+{
+    // the texture must be released with the context current, see `release`
+}
+
+const GLGlyph &GLGlyphFont::glyph(QChar ch)
+{
+    auto it = _hash_glyphs.constFind(ch.unicode());
+    if (it != _hash_glyphs.constEnd()) return *it;
+
+    add_glyph(ch);
+    return *_hash_glyphs.constFind(ch.unicode());
+}
+
+int GLGlyphFont::text_width(const QString &txt)
+{
+    int w = 0;
+    for (auto ch : txt)
+    {
+        w += glyph(ch).advance;
+    }
+
+    return w;
+}
+
+int GLGlyphFont::ascent() const
+{
+    return _fm.ascent();
+}
+
+int GLGlyphFont::height() const
+{
+    return _fm.height();
+}
+
+int GLGlyphFont::padding() const
+{
+    return glyph_padding;
+}
+
+int GLGlyphFont::atlas_width() const
+{
+    return _img.width();
+}
+
+int GLGlyphFont::atlas_height() const
+{
+    return _img.height();
+}
+
+qint64 GLGlyphFont::texture_bytes() const
+{
+    if (!_texture) return 0;
+
+    return qint64(_texture->width()) * _texture->height() * 4;
+}
+
+/**
+ * @brief GLGlyphFont::bind
+ * upload the atlas if glyphs were added since the last upload, then bind it
+ */
+void GLGlyphFont::bind()
+{
+    if (_dirty)
+    {
+        release();
+
+        _texture = new QOpenGLTexture(_img, QOpenGLTexture::DontGenerateMipMaps);
+        _texture->setMinificationFilter(QOpenGLTexture::Linear);
+        _texture->setMagnificationFilter(QOpenGLTexture::Linear);
+        _texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+
+        _dirty = false;
+    }
+
+    _texture->bind();
+}
+
+void GLGlyphFont::unbind()
+{
+    if (_texture) _texture->release();
+}
+
+void GLGlyphFont::release()
+{
+    delete _texture;
+    _texture = nullptr;
+    _dirty = true;
+}
+
+void GLGlyphFont::add_glyph(QChar ch)
+{
+    GLGlyph g;
+    g.advance = _fm.width(ch);
+
+    const int cellW = g.advance + 2*glyph_padding;
+    const int cellH = _fm.height() + 2*glyph_padding;
+
+    // shelf packing, start a new row when the current one is full
+    if (_pen_x + cellW > _img.width())
+    {
+        _pen_x = 0;
+        _pen_y += cellH;
+    }
+    while (_pen_y + cellH > _img.height())
+    {
+        grow();
+    }
+
+    g.rc_cell = QRect(_pen_x, _pen_y, cellW, cellH);
+    _pen_x += cellW;
+
+    QPainter p(&_img);
+    {
+        p.setRenderHint(QPainter::TextAntialiasing);
+        p.setFont(_font);
+        p.setPen(Qt::white);
+        p.drawText(QPoint(g.rc_cell.left() + glyph_padding, g.rc_cell.top() + glyph_padding + _fm.ascent()), QString(ch));
+    }
+
+    _hash_glyphs.insert(ch.unicode(), g);
+    _dirty = true;
+}
+
+void GLGlyphFont::grow()
+{
+    QImage img(_img.width(), _img.height() * 2, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::transparent);
+
+    QPainter p(&img);
+    {
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(0, 0, _img);
+    }
+
+    _img = img;
+    _dirty = true;
+}
+
+
+GLGlyphAtlas::GLGlyphAtlas()
+{
+
+}
+
+GLGlyphAtlas::~GLGlyphAtlas()
+{
+    qDeleteAll(_hash_fonts);
+}
+
+GLGlyphFont *GLGlyphAtlas::font(const QFont &f)
+{
+    // `QFont::key` allocates a string every call
+    for (const auto &known : _vec_known_fonts)
+    {
+        if (known.first == f) return known.second;
+    }
+
+    const auto key = f.key();
+
+    auto glyphFont = _hash_fonts.value(key);
+    if (!glyphFont)
+    {
+        glyphFont = new GLGlyphFont(f);
+        _hash_fonts.insert(key, glyphFont);
+    }
+
+    _vec_known_fonts.push_back(qMakePair(f, glyphFont));
+    return glyphFont;
+}
+
+qint64 GLGlyphAtlas::texture_bytes() const
+{
+    qint64 bytes = 0;
+    for (auto glyphFont : _hash_fonts)
+    {
+        bytes += glyphFont->texture_bytes();
+    }
+
+    return bytes;
+}
+
+void GLGlyphAtlas::release()
+{
+    for (auto glyphFont : _hash_fonts)
+    {
+        glyphFont->release();
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef GL_GLYPH_ATLAS_H
+#define GL_GLYPH_ATLAS_H
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QImage>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QRect>
+#include <QOpenGLTexture>
+
+
+/**
+ * @brief The GLGlyph struct
+ * rc_cell: cell of the glyph in the atlas image, including the padding
+ * advance: pen advance in pixels
+ */
+struct GLGlyph
+{
+    QRect   rc_cell;
+    int     advance;
+
+    GLGlyph()
+        : advance(0)
+    {}
+};
+
+/**
+ * @brief The GLGlyphFont class
+ * glyphs of one font rasterized once into a texture,
+ * printable ascii is rasterized up front, other chars on first use
+ */
+class GLGlyphFont
+{
+public:
+    GLGlyphFont(const QFont &f);
+    ~GLGlyphFont();
+
+    const GLGlyph &glyph(QChar ch);
+    int text_width(const QString &txt);
+
+    int ascent() const;
+    int height() const;
+    int padding() const;
+
+    int atlas_width() const;
+    int atlas_height() const;
+
+    // size of the uploaded texture
+    qint64 texture_bytes() const;
+
+    // the context must be current
+    void bind();
+    void unbind();
+    void release();
+
+private:
+    void add_glyph(QChar ch);
+    void grow();
+
+private:
+    QFont           _font;
+    QFontMetrics    _fm;
+
+    QImage          _img;
+    QOpenGLTexture  *_texture;
+    bool            _dirty;
+
+    int             _pen_x;
+    int             _pen_y;
+
+    QHash<ushort, GLGlyph>  _hash_glyphs;
+
+};
+
+/**
+ * @brief The GLGlyphAtlas class
+ * glyph fonts keyed by `QFont::key`,
+ * a font passed before is found by comparing the fonts, the key is only built for a new one
+ */
+class GLGlyphAtlas
+{
+public:
+    GLGlyphAtlas();
+    ~GLGlyphAtlas();
+
+    GLGlyphFont *font(const QFont &f);
+
+    qint64 texture_bytes() const;
+
+    // the context must be current
+    void release();
+
+private:
+    QHash<QString, GLGlyphFont *>   _hash_fonts;
+
+    QVector<QPair<QFont, GLGlyphFont *>>    _vec_known_fonts;
+
+};
+
+#endif // GL_GLYPH_ATLAS_H
@@ -0,0 +1,58 @@
+#include "gl_render_backend.h"
+
+
+GLRenderBackend::GLRenderBackend(GLFuncUtils *gl, GLGlyphAtlas *atlas)
+    : _gl(gl), _atlas(atlas)
+{
+}
+
+void GLRenderBackend::begin_frame(int w, int h, const GLColor3f &clBg)
+{
+    if (_transform.viewport().size() != QSize(w, h)) _transform.set_viewport(QRect(0, 0, w, h));
+    _gl->clear_color_buffer(clBg);
+}
+
+void GLRenderBackend::end_frame()
+{
+}
+
+void GLRenderBackend::set_color(const GLColor4f &cl)
+{
+    _gl->gl_color4f(cl);
+}
+
+void GLRenderBackend::draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    _gl->draw_ellipse(ptCenter, rx, ry);
+}
+
+void GLRenderBackend::draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    _gl->draw_ellipse(ptCenter, rx, ry, GL_LINE_LOOP);
+}
+
+void GLRenderBackend::draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode)
+{
+    _gl->draw_lines(vecPts, mode);
+}
+
+void GLRenderBackend::draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle)
+{
+    _gl->draw_triangle(vecPts, pos, angle);
+}
+
+void GLRenderBackend::set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts)
+{
+    _gl->set_marker_shape(shape, vecPts);
+}
+
+void GLRenderBackend::draw_markers(const QVector<GLMarkerInstance> &vecInstances)
+{
+    _gl->draw_markers(vecInstances);
+}
+
+void GLRenderBackend::draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                                int flags)
+{
+    _gl->draw_text(*_atlas->font(f), _transform, ptTopLeft, ptBottomRight, flags, txt);
+}
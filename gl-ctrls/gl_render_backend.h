@@ -0,0 +1,45 @@
+#ifndef GL_RENDER_BACKEND_H
+#define GL_RENDER_BACKEND_H
+
+#include "render_backend.h"
+#include "viewport_transform.h"
+
+
+/**
+ * @brief The GLRenderBackend class
+ * the scene through GLFuncUtils, the context of `gl` must be current,
+ * shapes drawn between `begin_batch` and `end_batch` of `gl` are recorded as usual
+ */
+class GLRenderBackend : public RenderBackend
+{
+public:
+    GLRenderBackend(GLFuncUtils *gl, GLGlyphAtlas *atlas);
+
+    using RenderBackend::set_color;
+
+    void begin_frame(int w, int h, const GLColor3f &clBg) override;
+    void end_frame() override;
+
+    void set_color(const GLColor4f &cl) override;
+
+    void draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode) override;
+    void draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle) override;
+
+    void set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts) override;
+    void draw_markers(const QVector<GLMarkerInstance> &vecInstances) override;
+
+    void draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                   int flags) override;
+
+private:
+    GLFuncUtils     *_gl;
+    GLGlyphAtlas    *_atlas;
+
+    // rebuilt when the frame size changes
+    ViewportTransform   _transform;
+
+};
+
+#endif // GL_RENDER_BACKEND_H
@@ -1,34 +1,206 @@
 #include "gl_utils.h"
+#include "viewport_transform.h"
 
+#include <QOpenGLContext>
+
+#include <cstring>
 
 
 static const float PI = 3.1415926f;
 
+static const int no_batch = -1;
+static const int stream_init_bytes = 4096;
+
+// every segment count divides the table size, so the table is sampled with a fixed step
+static const int circle_table_size = 360;
+static const int circle_segments[] = {12, 18, 24, 36, 45, 60, 72, 90, 120, 180, 360};
+static const float max_chord_error = 0.25f;     // pixel
+
+// the gpu is waited for at most this long before the mapped trail ring is written, ns
+static const GLuint64 trail_fence_timeout_ns = 100 * 1000 * 1000;
+
+// analytic shapes
+static const float sdf_disc = 0;
+static const float sdf_ring = 1;
+static const float sdf_line = 2;
+static const float sdf_triangle = 3;
+static const float sdf_line_half_width = 0.5f;     // pixel
+static const float sdf_aa_margin = 1.0f;           // pixel
+
+static const int marker_shape_count = 2;
+static const int marker_init_instances = 64;
+
+// the triangle corner comes from a per vertex index, the placement from a per instance attribute
+// the corner also gives the barycentric coordinate, the edges are anti-aliased with it if `u_aa` is 1
+static const char *marker_vs =
+        "#version 120\n"
+        "attribute float a_corner;\n"
+        "attribute vec4 a_instance;\n"
+        "uniform vec2 u_shapes[6];\n"
+        "varying vec3 v_bary;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 v = u_shapes[int(a_corner) + 3 * int(a_instance.w)];\n"
+        "    float c = cos(a_instance.z);\n"
+        "    float s = sin(a_instance.z);\n"
+        "    vec2 p = vec2(c*v.x - s*v.y, s*v.x + c*v.y) + a_instance.xy;\n"
+        "    v_bary = vec3(equal(vec3(a_corner), vec3(0.0, 1.0, 2.0)));\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+        "    gl_FrontColor = gl_Color;\n"
+        "}\n";
+
+static const char *marker_fs =
+        "#version 120\n"
+        "uniform float u_aa;\n"
+        "varying vec3 v_bary;\n"
+        "void main()\n"
+        "{\n"
+        "    vec3 d = v_bary / fwidth(v_bary);\n"
+        "    float cover = mix(1.0, clamp(min(min(d.x, d.y), d.z) + 0.5, 0.0, 1.0), u_aa);\n"
+        "    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * cover);\n"
+        "}\n";
+
+// coverage from the distance to the edge of the shape, in pixels,
+// fwidth converts the distance in shape units of discs, rings and triangles
+static const char *sdf_vs =
+        "#version 120\n"
+        "attribute vec2 a_pos;\n"
+        "attribute vec4 a_color;\n"
+        "attribute vec4 a_shape;\n"
+        "varying vec4 v_color;\n"
+        "varying vec4 v_shape;\n"
+        "void main()\n"
+        "{\n"
+        "    v_color = a_color;\n"
+        "    v_shape = a_shape;\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(a_pos, 0.0, 1.0);\n"
+        "}\n";
+
+static const char *sdf_fs =
+        "#version 120\n"
+        "varying vec4 v_color;\n"
+        "varying vec4 v_shape;\n"
+        "void main()\n"
+        "{\n"
+        "    float kind = v_shape.z;\n"
+        "    float hw = v_shape.w;\n"
+        "    float cover;\n"
+        "    if (kind < 0.5)\n"
+        "    {\n"
+        "        float f = length(v_shape.xy) - 1.0;\n"
+        "        cover = clamp(0.5 - f / fwidth(f), 0.0, 1.0);\n"
+        "    }\n"
+        "    else if (kind < 1.5)\n"
+        "    {\n"
+        "        float f = length(v_shape.xy) - 1.0;\n"
+        "        cover = clamp(hw + 0.5 - abs(f) / fwidth(f), 0.0, 1.0);\n"
+        "    }\n"
+        "    else if (kind < 2.5)\n"
+        "    {\n"
+        "        cover = clamp(hw + 0.5 - abs(v_shape.x), 0.0, 1.0);\n"
+        "    }\n"
+        "    else\n"
+        "    {\n"
+        "        vec3 b = vec3(v_shape.xy, 1.0 - v_shape.x - v_shape.y);\n"
+        "        vec3 d = b / fwidth(b);\n"
+        "        cover = clamp(min(min(d.x, d.y), d.z) + 0.5, 0.0, 1.0);\n"
+        "    }\n"
+        "    if (cover <= 0.0) discard;\n"
+        "    gl_FragColor = vec4(v_color.rgb, v_color.a * cover);\n"
+        "}\n";
+
+// the trail is scaled in the shader, so zooming never touches the buffer,
+// it is clipped to a circle and fades out with age
+static const char *trail_vs =
+        "#version 120\n"
+        "attribute vec3 a_vertex;\n"
+        "uniform float u_scale;\n"
+        "uniform float u_now;\n"
+        "varying vec2 v_pos;\n"
+        "varying float v_age;\n"
+        "void main()\n"
+        "{\n"
+        "    v_pos = a_vertex.xy * u_scale;\n"
+        "    v_age = u_now - a_vertex.z;\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(v_pos, 0.0, 1.0);\n"
+        "    gl_FrontColor = gl_Color;\n"
+        "}\n";
+
+static const char *trail_fs =
+        "#version 120\n"
+        "uniform float u_clip;\n"
+        "uniform float u_duration;\n"
+        "varying vec2 v_pos;\n"
+        "varying float v_age;\n"
+        "void main()\n"
+        "{\n"
+        "    if (dot(v_pos, v_pos) > u_clip * u_clip || v_age > u_duration) discard;\n"
+        "    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * (1.0 - v_age / u_duration));\n"
+        "}\n";
+
+
+/**
+ * @brief unit_circle_table
+ * cos/sin of the unit circle, built once and shared by every ellipse
+ */
+static const GLPoint2f *unit_circle_table()
+{
+    static const QVector<GLPoint2f> vec = []()
+    {
+        static const float angle_unit = 2 * PI / circle_table_size;
+
+        QVector<GLPoint2f> tmp(circle_table_size);
+        for (int i = 0; i < circle_table_size; ++i)
+        {
+            const float angle = angle_unit * i;
+            tmp[i] = GLPoint2f(cos(angle), sin(angle));
+        }
+        return tmp;
+    }();
+
+    return vec.constData();
+}
+
+
+GLFuncUtils::GLFuncUtils()
+    : _cur_color(1, 1, 1, 1), _viewport_w(0), _viewport_h(0),
+      _stream_vao(0), _stream_tex_vao(0), _stream_sdf_vao(0), _stream_vbo(0), _stream_capacity(0),
+      _recording_batch(no_batch),
+      _sdf_program(nullptr), _sdf_enabled(false),
+      _marker_program(nullptr), _marker_vao(0), _marker_corner_vbo(0), _marker_instance_vbo(0),
+      _marker_instance_capacity(0),
+      _trail_program(nullptr), _trail_vao(0), _trail_vbo(0), _trail_ibo(0), _trail_mapped(nullptr),
+      _trail_fence(nullptr), _trail_capacity(0), _trail_index_count(0),
+      _draw_calls(0)
+{
+
+}
+
+GLFuncUtils::~GLFuncUtils()
+{
+
+}
 
 /**
  * @brief GLFuncUtils::gl_point_2_qpointf
- * pay attention to the differences of coordinates
+ * pay attention to the differences of coordinates,
+ * one point, keep a ViewportTransform to convert many
  * @param pt
  * @param rcViewPort
  * @return
  */
 QPointF GLFuncUtils::gl_point_2_qpointf(const GLPoint2f &pt, const QRect &rcViewPort)
 {
-    // add 1
-    auto ptCenter = rect_center(rcViewPort);
-    double disX = static_cast<double>(pt.x * rcViewPort.width() / 2);
-    double disY = static_cast<double>(pt.y * rcViewPort.height() / 2);
-
-    return QPointF(ptCenter.x()+disX, ptCenter.y()-disY);
+    return ViewportTransform(rcViewPort).to_pixel(pt);
 }
 
+/**
+ * @brief GLFuncUtils::qpointf_2_gl_point
+ * the inverse of `gl_point_2_qpointf`
+ */
 GLPoint2f GLFuncUtils::qpointf_2_gl_point(const QPointF &pt, const QRect &rcViewPort)
 {
-    auto ptCenter = rect_center(rcViewPort);
-    float x = static_cast<float>((pt.x() - ptCenter.x()) / rcViewPort.width());
-    float y = static_cast<float>(-(pt.y() - ptCenter.y()) / rcViewPort.height());
-
-    return GLPoint2f(x, y);
+    return ViewportTransform(rcViewPort).to_gl(pt);
 }
 
 QColor GLFuncUtils::gl_color4f_2_qcolor(const GLColor4f &cl)
@@ -99,11 +271,13 @@ void GLFuncUtils::gl_point2f(const GLPoint2f &pt)
 
 void GLFuncUtils::gl_color3f(const GLColor3f &cl)
 {
+    _cur_color = GLColor4f(cl.r, cl.g, cl.b, 1);
     glColor3f(cl.r, cl.g, cl.b);
 }
 
 void GLFuncUtils::gl_color4f(const GLColor4f &cl)
 {
+    _cur_color = cl;
     glColor4f(cl.r, cl.g, cl.b, cl.a);
 }
 
@@ -123,49 +297,71 @@ void GLFuncUtils::gl_clear_color4f(const GLColor4f &cl)
     glClearColor(cl.r, cl.g, cl.b, cl.a);
 }
 
+void GLFuncUtils::clear_color_buffer(const GLColor3f &cl)
+{
+    gl_clear_color3f(cl);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
 void GLFuncUtils::draw_point(const GLPoint2f &pt)
 {
-    glBegin(GL_POINTS);
-    {
-        gl_point2f(pt);
-    }
-    glEnd();
+    submit_vertices(GL_POINTS, &pt, 1);
 }
 
 void GLFuncUtils::draw_line(const GLPoint2f &pt1, const GLPoint2f &pt2)
 {
-    glBegin(GL_LINES);
+    const GLPoint2f pts[] = {pt1, pt2};
+    if (use_sdf())
     {
-        gl_point2f(pt1);
-        gl_point2f(pt2);
+        sdf_lines(GL_LINES, pts, 2);
+        return;
     }
-    glEnd();
+
+    submit_vertices(GL_LINES, pts, 2);
 }
 
 void GLFuncUtils::draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode)
 {
-    glBegin(mode);
+    if (use_sdf() && (mode == GL_LINES || mode == GL_LINE_STRIP || mode == GL_LINE_LOOP))
     {
-        for (auto pt : vecPts)
-        {
-            gl_point2f(pt);
-        }
+        sdf_lines(mode, vecPts.constData(), vecPts.size());
+        return;
     }
-    glEnd();
+
+    submit_vertices(mode, vecPts.constData(), vecPts.size());
 }
 
 void GLFuncUtils::draw_triangle(const QVector<GLPoint2f> &vecPts)
 {
     assert (vecPts.length() == 3);
 
-    glBegin(GL_TRIANGLES);
+    if (use_sdf())
     {
-        for (auto pt : vecPts)
+        const GLSdfVertex pts[] =
         {
-            gl_point2f(pt);
-        }
+            GLSdfVertex(vecPts.at(0), _cur_color, 1, 0, sdf_triangle),
+            GLSdfVertex(vecPts.at(1), _cur_color, 0, 1, sdf_triangle),
+            GLSdfVertex(vecPts.at(2), _cur_color, 0, 0, sdf_triangle)
+        };
+        submit_sdf_vertices(pts, 3);
+        return;
     }
-    glEnd();
+
+    submit_vertices(GL_TRIANGLES, vecPts.constData(), vecPts.size());
+}
+
+/**
+ * @brief GLFuncUtils::draw_triangle
+ * @param pos: where the origin of the triangle goes
+ * @param angle: counterclockwise rotation in radian
+ */
+void GLFuncUtils::draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle)
+{
+    glPushMatrix();
+    glTranslatef(pos.x, pos.y, 0);
+    glRotatef(angle * 180 / PI, 0, 0, 1);
+    draw_triangle(vecPts);
+    glPopMatrix();
 }
 
 void GLFuncUtils::draw_rect(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight)
@@ -173,26 +369,13 @@ void GLFuncUtils::draw_rect(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBotto
     GLPoint2f ptTopRight(ptBottomRight.x, ptTopLeft.y);
     GLPoint2f ptBottomLeft(ptTopLeft.x, ptBottomRight.y);
 
-    glBegin(GL_QUADS);
-    {
-        gl_point2f(ptTopLeft);
-        gl_point2f(ptTopRight);
-        gl_point2f(ptBottomRight);
-        gl_point2f(ptBottomLeft);
-    }
-    glEnd();
+    const GLPoint2f pts[] = {ptTopLeft, ptTopRight, ptBottomRight, ptBottomLeft};
+    submit_vertices(GL_QUADS, pts, 4);
 }
 
 void GLFuncUtils::draw_polygon(const QVector<GLPoint2f> &vecPts)
 {
-    glBegin(GL_POLYGON);
-    {
-        for (auto pt : vecPts)
-        {
-            gl_point2f(pt);
-        }
-    }
-    glEnd();
+    submit_vertices(GL_POLYGON, vecPts.constData(), vecPts.size());
 }
 
 void GLFuncUtils::draw_ellipse(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight, GLenum mode)
@@ -215,40 +398,33 @@ void GLFuncUtils::draw_ellipse(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBo
  */
 void GLFuncUtils::draw_ellipse(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, GLenum mode)
 {
-    static const int count = 360;
-    static const float angle_unit = 2 * PI / count;
-
-    glBegin(mode);
+    if (use_sdf() && (mode == GL_POLYGON || mode == GL_TRIANGLE_FAN || mode == GL_LINE_LOOP))
     {
-        for (int i = 0; i < count; ++i)
-        {
-            const float angle = angle_unit * i;
-            GLfloat x = ptCenter.x + rx * cos(angle);
-            GLfloat y = ptCenter.y + ry * sin(angle);
-
-            glVertex2f(x, y);
-        }
+        sdf_ellipse(ptCenter, rx, ry, mode == GL_LINE_LOOP);
+        return;
     }
-    glEnd();
+
+    ellipse_vertices(ptCenter, rx, ry, _vec_scratch_pts);
+    submit_vertices(mode, _vec_scratch_pts.constData(), _vec_scratch_pts.size());
 }
 
 /**
  * @brief GLFuncUtils::draw_img, the texture is bound outside, before calling this method
+ * textured polygons are always streamed, they are never recorded into a batch
  * @param
  * vecPts: vector of polygon points
  */
 void GLFuncUtils::draw_img(const QVector<GLPoint2f> &vecPts)
 {
-    glEnable(GL_TEXTURE_2D);
-    glBegin(GL_POLYGON);
+    _vec_scratch_tex_pts.resize(vecPts.size());
+    for (int i = 0; i < vecPts.size(); ++i)
     {
-        for (auto pt : vecPts)
-        {
-            glTexCoord2f(gl_coord_2_texture(pt.x), gl_coord_2_texture(pt.y));
-            gl_point2f(pt);
-        }
+        const auto &pt = vecPts.at(i);
+        _vec_scratch_tex_pts[i] = GLTexVertex2f(pt.x, pt.y, gl_coord_2_texture(pt.x), gl_coord_2_texture(pt.y));
     }
-    glEnd();
+
+    glEnable(GL_TEXTURE_2D);
+    submit_tex_vertices(GL_POLYGON, _vec_scratch_tex_pts.constData(), _vec_scratch_tex_pts.size());
     glDisable(GL_TEXTURE_2D);
 }
 
@@ -290,10 +466,1120 @@ void GLFuncUtils::draw_text(QPainter &p, const QRect &rcViewPort, const GLPoint2
     glEnable(GL_DEPTH_TEST);
 }
 
+/**
+ * @brief GLFuncUtils::draw_text
+ * single line text drawn as textured quads from the glyph atlas, in the current color,
+ * without any QPainter on the widget
+ * @param flags: Qt::AlignmentFlag
+ */
+void GLFuncUtils::draw_text(GLGlyphFont &glyphFont, const QRect &rcViewPort, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                            int flags, const QString &text)
+{
+    draw_text(glyphFont, ViewportTransform(rcViewPort), ptTopLeft, ptBottomRight, flags, text);
+}
+
+/**
+ * @brief GLFuncUtils::draw_text
+ * the pixel corners of all glyphs are converted back to gl in one batch
+ */
+void GLFuncUtils::draw_text(GLGlyphFont &glyphFont, const ViewportTransform &transform, const GLPoint2f &ptTopLeft,
+                            const GLPoint2f &ptBottomRight, int flags, const QString &text)
+{
+    const auto &rcViewPort = transform.viewport();
+    if (text.isEmpty() || rcViewPort.width() <= 0 || rcViewPort.height() <= 0) return;
+
+    auto topLeft = transform.to_pixel(ptTopLeft);
+    auto bottomRight = transform.to_pixel(ptBottomRight);
+    auto rc = QRect(topLeft.toPoint(), bottomRight.toPoint());
+
+    // resolve every glyph first, the atlas may grow while adding new ones
+    const int w = glyphFont.text_width(text);
+    const int h = glyphFont.height();
+
+    int x = rc.left();
+    if (flags & Qt::AlignRight) x = rc.left() + rc.width() - w;
+    else if (flags & Qt::AlignHCenter) x = rc.left() + (rc.width() - w) / 2;
+
+    int y = rc.top();
+    if (flags & Qt::AlignBottom) y = rc.top() + rc.height() - h;
+    else if (flags & Qt::AlignVCenter) y = rc.top() + (rc.height() - h) / 2;
+
+    // the texture coordinates and the top left and bottom right pixel of every glyph cell
+    const float su = 1.0f / glyphFont.atlas_width();
+    const float sv = 1.0f / glyphFont.atlas_height();
+    const int pad = glyphFont.padding();
+    const int n = text.size();
+
+    _vec_scratch_tex_pts.resize(n * 4);
+    _vec_scratch_pixel_pts.resize(n * 2);
+    for (int i = 0; i < n; ++i)
+    {
+        const auto &g = glyphFont.glyph(text.at(i));
+        const auto &cell = g.rc_cell;
+
+        const float u1 = cell.left() * su;
+        const float u2 = (cell.left() + cell.width()) * su;
+        const float v1 = cell.top() * sv;
+        const float v2 = (cell.top() + cell.height()) * sv;
+
+        _vec_scratch_tex_pts[i*4]     = GLTexVertex2f(0, 0, u1, v1);
+        _vec_scratch_tex_pts[i*4 + 1] = GLTexVertex2f(0, 0, u2, v1);
+        _vec_scratch_tex_pts[i*4 + 2] = GLTexVertex2f(0, 0, u2, v2);
+        _vec_scratch_tex_pts[i*4 + 3] = GLTexVertex2f(0, 0, u1, v2);
+
+        _vec_scratch_pixel_pts[i*2]     = QPointF(x - pad, y - pad);
+        _vec_scratch_pixel_pts[i*2 + 1] = QPointF(x - pad + cell.width(), y - pad + cell.height());
+
+        x += g.advance;
+    }
+
+    _vec_scratch_pts.resize(n * 2);
+    transform.to_gl(_vec_scratch_pixel_pts.constData(), _vec_scratch_pts.data(), n * 2);
+
+    for (int i = 0; i < n; ++i)
+    {
+        const auto &p1 = _vec_scratch_pts.at(i*2);
+        const auto &p2 = _vec_scratch_pts.at(i*2 + 1);
+        auto *quad = _vec_scratch_tex_pts.data() + i*4;
+
+        quad[0].x = p1.x;
+        quad[0].y = p1.y;
+        quad[1].x = p2.x;
+        quad[1].y = p1.y;
+        quad[2].x = p2.x;
+        quad[2].y = p2.y;
+        quad[3].x = p1.x;
+        quad[3].y = p2.y;
+    }
+
+    const bool depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_TEXTURE_2D);
+    glyphFont.bind();
+    {
+        submit_tex_vertices(GL_QUADS, _vec_scratch_tex_pts.constData(), _vec_scratch_tex_pts.size());
+    }
+    glyphFont.unbind();
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+}
+
+/**
+ * @brief GLFuncUtils::draw_call_count
+ * draw calls issued by the draw methods since the last reset, QPainter calls are not counted
+ */
+int GLFuncUtils::draw_call_count() const
+{
+    return _draw_calls;
+}
+
+void GLFuncUtils::reset_draw_call_count()
+{
+    _draw_calls = 0;
+}
+
 void GLFuncUtils::reset_color()
 {
+    _cur_color = GLColor4f(1, 1, 1, 0);
     glColor4f(1, 1, 1, 0);
 }
 
+/**
+ * @brief GLFuncUtils::set_viewport_size
+ * call it from `resizeGL`, recorded batches keep the tessellation of the old size
+ * @param w
+ * @param h
+ */
+void GLFuncUtils::set_viewport_size(int w, int h)
+{
+    _viewport_w = w;
+    _viewport_h = h;
+}
+
+/**
+ * @brief GLFuncUtils::ellipse_segments
+ * the least segment count whose chords stay within `max_chord_error` pixels of the arc,
+ * the radius is measured in the viewport, the modelview matrix is ignored
+ * @param rx
+ * @param ry
+ * @return
+ */
+int GLFuncUtils::ellipse_segments(GLfloat rx, GLfloat ry) const
+{
+    // unknown viewport, keep the full resolution
+    if (_viewport_w <= 0 || _viewport_h <= 0) return circle_table_size;
+
+    const float r = qMax(qAbs(rx) * _viewport_w, qAbs(ry) * _viewport_h) / 2;
+    if (r <= max_chord_error) return circle_segments[0];
+
+    const float need = PI / acos(1 - max_chord_error / r);
+    for (auto n : circle_segments)
+    {
+        if (n >= need) return n;
+    }
+
+    return circle_table_size;
+}
+
+/**
+ * @brief GLFuncUtils::ellipse_vertices
+ * `ellipse_segments` vertices sampled from the unit circle table, written into the storage `vecPts` already has
+ */
+void GLFuncUtils::ellipse_vertices(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, QVector<GLPoint2f> &vecPts) const
+{
+    const GLPoint2f *table = unit_circle_table();
+    const int count = ellipse_segments(rx, ry);
+    const int step = circle_table_size / count;
+
+    vecPts.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const auto &unit = table[i * step];
+        GLfloat x = ptCenter.x + rx * unit.x;
+        GLfloat y = ptCenter.y + ry * unit.y;
+
+        vecPts[i] = GLPoint2f(x, y);
+    }
+}
+
+/**
+ * @brief GLFuncUtils::init_gl_buffers
+ * create the reusable stream buffer, call it after `initializeOpenGLFunctions`,
+ * without it every primitive falls back to immediate mode
+ */
+void GLFuncUtils::init_gl_buffers()
+{
+    if (_stream_vbo != 0) return;
+
+    _stream_capacity = stream_init_bytes;
+    glGenBuffers(1, &_stream_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _stream_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _stream_capacity, nullptr, GL_STREAM_DRAW);
+
+    // position only, the color comes from the current color
+    glGenVertexArrays(1, &_stream_vao);
+    glBindVertexArray(_stream_vao);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(GLPoint2f), nullptr);
+
+    // position and texture coordinate
+    glGenVertexArrays(1, &_stream_tex_vao);
+    glBindVertexArray(_stream_tex_vao);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(GLTexVertex2f), nullptr);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(GLTexVertex2f), reinterpret_cast<const void *>(2 * sizeof(GLfloat)));
+
+    // analytic shapes, the geometry path is used if the shader is not available
+    _sdf_program = new QOpenGLShaderProgram();
+    _sdf_program->addShaderFromSourceCode(QOpenGLShader::Vertex, sdf_vs);
+    _sdf_program->addShaderFromSourceCode(QOpenGLShader::Fragment, sdf_fs);
+    _sdf_program->bindAttributeLocation("a_pos", 0);
+    _sdf_program->bindAttributeLocation("a_color", 1);
+    _sdf_program->bindAttributeLocation("a_shape", 2);
+    if (_sdf_program->link())
+    {
+        glGenVertexArrays(1, &_stream_sdf_vao);
+        glBindVertexArray(_stream_sdf_vao);
+        set_sdf_attributes();
+    }
+    else
+    {
+        delete _sdf_program;
+        _sdf_program = nullptr;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // instanced markers, drawn one by one if the shader is not available
+    _marker_program = new QOpenGLShaderProgram();
+    _marker_program->addShaderFromSourceCode(QOpenGLShader::Vertex, marker_vs);
+    _marker_program->addShaderFromSourceCode(QOpenGLShader::Fragment, marker_fs);
+    _marker_program->bindAttributeLocation("a_corner", 0);
+    _marker_program->bindAttributeLocation("a_instance", 1);
+    if (!_marker_program->link())
+    {
+        delete _marker_program;
+        _marker_program = nullptr;
+        return;
+    }
+
+    static const GLfloat corners[] = {0, 1, 2};
+    glGenBuffers(1, &_marker_corner_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _marker_corner_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    _marker_instance_capacity = marker_init_instances * static_cast<int>(sizeof(GLMarkerInstance));
+    glGenBuffers(1, &_marker_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _marker_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _marker_instance_capacity, nullptr, GL_STREAM_DRAW);
+
+    glGenVertexArrays(1, &_marker_vao);
+    glBindVertexArray(_marker_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _marker_corner_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, _marker_instance_vbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GLMarkerInstance), nullptr);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLFuncUtils::release_gl_buffers()
+{
+    invalidate_batches();
+    release_trail_buffer();
+    release_time_queries();
+
+    delete _marker_program;
+    _marker_program = nullptr;
+
+    if (_marker_vao != 0) glDeleteVertexArrays(1, &_marker_vao);
+    if (_marker_corner_vbo != 0) glDeleteBuffers(1, &_marker_corner_vbo);
+    if (_marker_instance_vbo != 0) glDeleteBuffers(1, &_marker_instance_vbo);
+
+    _marker_vao = 0;
+    _marker_corner_vbo = 0;
+    _marker_instance_vbo = 0;
+    _marker_instance_capacity = 0;
+
+    delete _sdf_program;
+    _sdf_program = nullptr;
+
+    if (_stream_vao != 0) glDeleteVertexArrays(1, &_stream_vao);
+    if (_stream_tex_vao != 0) glDeleteVertexArrays(1, &_stream_tex_vao);
+    if (_stream_sdf_vao != 0) glDeleteVertexArrays(1, &_stream_sdf_vao);
+    if (_stream_vbo != 0) glDeleteBuffers(1, &_stream_vbo);
+
+    _stream_vao = 0;
+    _stream_tex_vao = 0;
+    _stream_sdf_vao = 0;
+    _stream_vbo = 0;
+    _stream_capacity = 0;
+}
+
+/**
+ * @brief GLFuncUtils::begin_batch
+ * primitives drawn until `end_batch` are recorded into batch `id` instead of being drawn,
+ * the current color is baked into every recorded vertex
+ * @param id
+ */
+void GLFuncUtils::begin_batch(int id)
+{
+    // without buffers the primitives are drawn immediately
+    if (_stream_vbo == 0) return;
+
+    invalidate_batch(id);
+
+    _recording_batch = id;
+    _vec_rec_vertices.clear();
+    _vec_rec_ranges.clear();
+    _vec_rec_sdf_vertices.clear();
+}
+
+void GLFuncUtils::end_batch()
+{
+    if (_recording_batch == no_batch) return;
+
+    GLBatch batch;
+    batch.ranges = _vec_rec_ranges;
+
+    glGenBuffers(1, &batch.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    glBufferData(GL_ARRAY_BUFFER, _vec_rec_vertices.size() * static_cast<int>(sizeof(GLVertex2f)),
+                 _vec_rec_vertices.constData(), GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &batch.vao);
+    glBindVertexArray(batch.vao);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(GLVertex2f), nullptr);
+    glColorPointer(4, GL_FLOAT, sizeof(GLVertex2f), reinterpret_cast<const void *>(2 * sizeof(GLfloat)));
+
+    batch.bytes = _vec_rec_vertices.size() * static_cast<int>(sizeof(GLVertex2f));
+
+    if (!_vec_rec_sdf_vertices.isEmpty())
+    {
+        const int bytes = _vec_rec_sdf_vertices.size() * static_cast<int>(sizeof(GLSdfVertex));
+        batch.sdf_count = _vec_rec_sdf_vertices.size();
+        batch.bytes += bytes;
+
+        glGenBuffers(1, &batch.sdf_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, batch.sdf_vbo);
+        glBufferData(GL_ARRAY_BUFFER, bytes, _vec_rec_sdf_vertices.constData(), GL_STATIC_DRAW);
+
+        glGenVertexArrays(1, &batch.sdf_vao);
+        glBindVertexArray(batch.sdf_vao);
+        set_sdf_attributes();
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _hash_batches.insert(_recording_batch, batch);
+    _recording_batch = no_batch;
+}
+
+/**
+ * @brief GLFuncUtils::draw_batch
+ * @param id
+ * @return false if the batch has not been recorded yet
+ */
+bool GLFuncUtils::draw_batch(int id)
+{
+    auto it = _hash_batches.constFind(id);
+    if (it == _hash_batches.constEnd()) return false;
+
+    glBindVertexArray(it->vao);
+    for (const auto &range : it->ranges)
+    {
+        glDrawArrays(range.mode, range.first, range.count);
+        ++_draw_calls;
+    }
+    glBindVertexArray(0);
+
+    if (it->sdf_count > 0)
+    {
+        draw_sdf_vertices(it->sdf_vao, 0, it->sdf_count);
+    }
+
+    // the current color is undefined after drawing with a color array
+    gl_color4f(_cur_color);
+
+    return true;
+}
+
+bool GLFuncUtils::has_batch(int id) const
+{
+    return _hash_batches.contains(id);
+}
+
+void GLFuncUtils::invalidate_batch(int id)
+{
+    auto it = _hash_batches.find(id);
+    if (it == _hash_batches.end()) return;
+
+    glDeleteVertexArrays(1, &it->vao);
+    glDeleteBuffers(1, &it->vbo);
+    if (it->sdf_vao != 0) glDeleteVertexArrays(1, &it->sdf_vao);
+    if (it->sdf_vbo != 0) glDeleteBuffers(1, &it->sdf_vbo);
+    _hash_batches.erase(it);
+}
+
+void GLFuncUtils::invalidate_batches()
+{
+    for (auto id : _hash_batches.keys())
+    {
+        invalidate_batch(id);
+    }
+}
+
+/**
+ * @brief GLFuncUtils::set_sdf_shapes
+ * draw circles, rings, lines and triangles as analytic shapes anti-aliased in the fragment shader,
+ * meant for surfaces without multisampling, recorded batches keep the path they were recorded with
+ * @param b
+ */
+void GLFuncUtils::set_sdf_shapes(bool b)
+{
+    _sdf_enabled = b;
+}
+
+bool GLFuncUtils::sdf_shapes() const
+{
+    return use_sdf();
+}
+
+/**
+ * @brief GLFuncUtils::buffer_bytes
+ * storage of the stream, marker, trail and batch buffers, textures and framebuffers are not included
+ */
+qint64 GLFuncUtils::buffer_bytes() const
+{
+    qint64 bytes = _stream_capacity + _marker_instance_capacity;
+    bytes += _trail_capacity * static_cast<qint64>(sizeof(GLPoint3f));
+    bytes += _trail_index_count * static_cast<qint64>(sizeof(quint32));
+
+    for (const auto &batch : _hash_batches)
+    {
+        bytes += batch.bytes;
+    }
+
+    return bytes;
+}
+
+/**
+ * @brief GLFuncUtils::set_marker_shape
+ * @param shape: 0 or 1
+ * @param vecPts: triangle around the origin of the marker
+ */
+void GLFuncUtils::set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts)
+{
+    assert (shape >= 0 && shape < marker_shape_count && vecPts.size() == 3);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        _marker_shapes[shape*3 + i] = vecPts.at(i);
+    }
+}
+
+/**
+ * @brief GLFuncUtils::draw_markers
+ * all markers in one instanced draw call, the instances are streamed every call
+ * @param vecInstances
+ */
+void GLFuncUtils::draw_markers(const QVector<GLMarkerInstance> &vecInstances)
+{
+    if (vecInstances.isEmpty()) return;
+
+    if (!_marker_program)
+    {
+        for (const auto &m : vecInstances)
+        {
+            glPushMatrix();
+            glTranslatef(m.x, m.y, 0);
+            glRotatef(m.angle * 180 / PI, 0, 0, 1);
+            submit_vertices(GL_TRIANGLES, _marker_shapes + 3*static_cast<int>(m.shape), 3);
+            glPopMatrix();
+        }
+        return;
+    }
+
+    const int bytes = vecInstances.size() * static_cast<int>(sizeof(GLMarkerInstance));
+    while (_marker_instance_capacity < bytes)
+    {
+        _marker_instance_capacity *= 2;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _marker_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _marker_instance_capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vecInstances.constData());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const bool aa = use_sdf();
+    if (aa)
+    {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    _marker_program->bind();
+    _marker_program->setUniformValueArray("u_shapes", reinterpret_cast<const GLfloat *>(_marker_shapes),
+                                          marker_shape_count * 3, 2);
+    _marker_program->setUniformValue("u_aa", aa ? 1.0f : 0.0f);
+
+    glBindVertexArray(_marker_vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 3, vecInstances.size());
+    ++_draw_calls;
+    glBindVertexArray(0);
+
+    _marker_program->release();
+
+    if (aa) glDisable(GL_BLEND);
+}
+
+/**
+ * @brief GLFuncUtils::init_trail_buffer
+ * the vertex ring is mapped once for the life of the buffer, vertices are written straight into it,
+ * falls back to `glBufferSubData` without immutable storage or if the mapping fails,
+ * and to the fixed pipeline without fading and clipping if the shader is not available
+ * @param capacity: vertex count of the ring
+ */
+void GLFuncUtils::init_trail_buffer(int capacity)
+{
+    if (_trail_vbo != 0 || capacity <= 0) return;
+
+    _trail_capacity = capacity;
+    const GLsizeiptr bytes = capacity * static_cast<GLsizeiptr>(sizeof(GLPoint3f));
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    const QOpenGLContext *ctx = QOpenGLContext::currentContext();
+    const bool hasStorage = (ctx->format().version() >= qMakePair(4, 4) || ctx->hasExtension("GL_ARB_buffer_storage"));
+
+    glGenBuffers(1, &_trail_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _trail_vbo);
+    if (hasStorage)
+    {
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, mapFlags | GL_DYNAMIC_STORAGE_BIT);
+        _trail_mapped = static_cast<GLPoint3f *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, mapFlags));
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    _trail_program = new QOpenGLShaderProgram();
+    _trail_program->addShaderFromSourceCode(QOpenGLShader::Vertex, trail_vs);
+    _trail_program->addShaderFromSourceCode(QOpenGLShader::Fragment, trail_fs);
+    _trail_program->bindAttributeLocation("a_vertex", 1);
+    if (!_trail_program->link())
+    {
+        delete _trail_program;
+        _trail_program = nullptr;
+    }
+
+    glGenBuffers(1, &_trail_ibo);
+
+    glGenVertexArrays(1, &_trail_vao);
+    glBindVertexArray(_trail_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _trail_ibo);
+    if (_trail_program)
+    {
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLPoint3f), nullptr);
+    }
+    else
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(GLPoint3f), nullptr);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLFuncUtils::release_trail_buffer()
+{
+    delete _trail_program;
+    _trail_program = nullptr;
+
+    if (_trail_fence) glDeleteSync(_trail_fence);
+    _trail_fence = nullptr;
+
+    if (_trail_mapped)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _trail_vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if (_trail_vao != 0) glDeleteVertexArrays(1, &_trail_vao);
+    if (_trail_vbo != 0) glDeleteBuffers(1, &_trail_vbo);
+    if (_trail_ibo != 0) glDeleteBuffers(1, &_trail_ibo);
+
+    _trail_vao = 0;
+    _trail_vbo = 0;
+    _trail_ibo = 0;
+    _trail_mapped = nullptr;
+    _trail_capacity = 0;
+    _trail_index_count = 0;
+}
+
+/**
+ * @brief GLFuncUtils::wait_trail_fence
+ * a coherent mapping does not keep the gpu from reading slots the cpu overwrites,
+ * the draws of the earlier frames may read any slot of the ring, all of them are finished before it is written,
+ * the fence of the last frame has usually passed by the next one
+ */
+void GLFuncUtils::wait_trail_fence()
+{
+    if (!_trail_fence) return;
+
+    glClientWaitSync(_trail_fence, GL_SYNC_FLUSH_COMMANDS_BIT, trail_fence_timeout_ns);
+    glDeleteSync(_trail_fence);
+    _trail_fence = nullptr;
+}
+
+/**
+ * @brief GLFuncUtils::write_trail_vertices
+ * only the written slots reach the gpu, a run past the end of the ring wraps to its start
+ */
+void GLFuncUtils::write_trail_vertices(int slot, const GLPoint3f *pts, int count)
+{
+    if (_trail_vbo == 0 || count <= 0) return;
+
+    if (_trail_mapped) wait_trail_fence();
+
+    while (count > 0)
+    {
+        const int n = qMin(count, _trail_capacity - slot);
+
+        if (_trail_mapped)
+        {
+            memcpy(_trail_mapped + slot, pts, n * sizeof(GLPoint3f));
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _trail_vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, slot * static_cast<GLintptr>(sizeof(GLPoint3f)),
+                            n * static_cast<GLsizeiptr>(sizeof(GLPoint3f)), pts);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        pts += n;
+        count -= n;
+        slot = 0;
+    }
+}
+
+/**
+ * @brief GLFuncUtils::set_trail_indices
+ * slots of the line strip drawn before the tail
+ */
+void GLFuncUtils::set_trail_indices(const QVector<quint32> &vecIndices)
+{
+    if (_trail_vbo == 0) return;
+
+    _trail_index_count = vecIndices.size();
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _trail_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _trail_index_count * static_cast<GLsizeiptr>(sizeof(quint32)),
+                 vecIndices.constData(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/**
+ * @brief GLFuncUtils::draw_trail
+ * the indexed strip, then the tail read straight from the ring, in the current color
+ * @param scale: unit of the vertices to gl coordinate
+ * @param clip: radius in gl coordinate, the trail outside is not drawn
+ * @param now: time of a vertex that is drawn opaque
+ * @param duration: age at which a vertex is faded out
+ * @param tailSlot: first slot of the tail, the tail must not wrap
+ * @param tailCount
+ */
+void GLFuncUtils::draw_trail(GLfloat scale, GLfloat clip, GLfloat now, GLfloat duration, int tailSlot, int tailCount)
+{
+    if (_trail_vbo == 0 || duration <= 0) return;
+    if (_trail_index_count < 2 && tailCount < 2) return;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // smooth lines stand in for multisampling
+    if (_sdf_enabled) glEnable(GL_LINE_SMOOTH);
+
+    if (_trail_program)
+    {
+        _trail_program->bind();
+        _trail_program->setUniformValue("u_scale", scale);
+        _trail_program->setUniformValue("u_clip", clip);
+        _trail_program->setUniformValue("u_now", now);
+        _trail_program->setUniformValue("u_duration", duration);
+    }
+    else
+    {
+        glPushMatrix();
+        glScalef(scale, scale, 1);
+    }
+
+    glBindVertexArray(_trail_vao);
+    {
+        if (_trail_index_count >= 2)
+        {
+            glDrawElements(GL_LINE_STRIP, _trail_index_count, GL_UNSIGNED_INT, nullptr);
+            ++_draw_calls;
+        }
+
+        if (tailCount >= 2)
+        {
+            glDrawArrays(GL_LINE_STRIP, tailSlot, tailCount);
+            ++_draw_calls;
+        }
+    }
+    glBindVertexArray(0);
+
+    // the mapped slots these draws read are not written before they are finished
+    if (_trail_mapped)
+    {
+        if (_trail_fence) glDeleteSync(_trail_fence);
+        _trail_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    if (_trail_program)
+    {
+        _trail_program->release();
+    }
+    else
+    {
+        glPopMatrix();
+    }
+
+    glDisable(GL_LINE_SMOOTH);
+    glDisable(GL_BLEND);
+}
+
+void GLFuncUtils::submit_vertices(GLenum mode, const GLPoint2f *pts, int count)
+{
+    if (count <= 0) return;
+
+    if (_recording_batch != no_batch)
+    {
+        record_vertices(mode, pts, count);
+    }
+    else if (_stream_vbo != 0)
+    {
+        stream_vertices(mode, pts, count);
+    }
+    else
+    {
+        ++_draw_calls;
+        glBegin(mode);
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                gl_point2f(pts[i]);
+            }
+        }
+        glEnd();
+    }
+}
+
+/**
+ * @brief GLFuncUtils::record_vertices
+ * batches keep list primitives only, so that neighbouring shapes share one draw call
+ */
+void GLFuncUtils::record_vertices(GLenum mode, const GLPoint2f *pts, int count)
+{
+    GLenum listMode = mode;
+    _vec_rec_indices.clear();
+
+    switch (mode)
+    {
+    case GL_POLYGON:
+    case GL_TRIANGLE_FAN:
+        listMode = GL_TRIANGLES;
+        for (int i = 1; i+1 < count; ++i)
+        {
+            _vec_rec_indices << 0 << i << i+1;
+        }
+        break;
+    case GL_TRIANGLE_STRIP:
+        listMode = GL_TRIANGLES;
+        for (int i = 0; i+2 < count; ++i)
+        {
+            // keep the winding of the odd triangles
+            if (i % 2 == 0) _vec_rec_indices << i << i+1 << i+2;
+            else _vec_rec_indices << i+1 << i << i+2;
+        }
+        break;
+    case GL_QUADS:
+        listMode = GL_TRIANGLES;
+        for (int i = 0; i+3 < count; i += 4)
+        {
+            _vec_rec_indices << i << i+1 << i+2 << i << i+2 << i+3;
+        }
+        break;
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+        listMode = GL_LINES;
+        for (int i = 0; i+1 < count; ++i)
+        {
+            _vec_rec_indices << i << i+1;
+        }
+        if (mode == GL_LINE_LOOP && count > 2)
+        {
+            _vec_rec_indices << count-1 << 0;
+        }
+        break;
+    default:
+        for (int i = 0; i < count; ++i)
+        {
+            _vec_rec_indices << i;
+        }
+        break;
+    }
+
+    append_batch_range(listMode, pts, _vec_rec_indices.constData(), _vec_rec_indices.size());
+}
+
+void GLFuncUtils::stream_vertices(GLenum mode, const GLPoint2f *pts, int count)
+{
+    const int bytes = count * static_cast<int>(sizeof(GLPoint2f));
+    reserve_stream_buffer(bytes);
+
+    // orphan the previous storage, so the driver never waits for pending draws
+    glBindBuffer(GL_ARRAY_BUFFER, _stream_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _stream_capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, pts);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(_stream_vao);
+    glDrawArrays(mode, 0, count);
+    ++_draw_calls;
+    glBindVertexArray(0);
+}
+
+void GLFuncUtils::stream_tex_vertices(GLenum mode, const GLTexVertex2f *pts, int count)
+{
+    const int bytes = count * static_cast<int>(sizeof(GLTexVertex2f));
+    reserve_stream_buffer(bytes);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _stream_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _stream_capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, pts);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(_stream_tex_vao);
+    glDrawArrays(mode, 0, count);
+    ++_draw_calls;
+    glBindVertexArray(0);
+}
+
+void GLFuncUtils::submit_tex_vertices(GLenum mode, const GLTexVertex2f *pts, int count)
+{
+    if (count <= 0) return;
+
+    if (_stream_vbo != 0)
+    {
+        stream_tex_vertices(mode, pts, count);
+    }
+    else
+    {
+        ++_draw_calls;
+        glBegin(mode);
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                glTexCoord2f(pts[i].s, pts[i].t);
+                glVertex2f(pts[i].x, pts[i].y);
+            }
+        }
+        glEnd();
+    }
+}
+
+/**
+ * @brief GLFuncUtils::reserve_stream_buffer
+ * grow the capacity only, the storage is reallocated by the next orphaning upload
+ */
+void GLFuncUtils::reserve_stream_buffer(int bytes)
+{
+    while (_stream_capacity < bytes)
+    {
+        _stream_capacity *= 2;
+    }
+}
+
+void GLFuncUtils::append_batch_range(GLenum mode, const GLPoint2f *pts, const int *indices, int count)
+{
+    if (count <= 0) return;
+
+    const GLint first = _vec_rec_vertices.size();
+    for (int i = 0; i < count; ++i)
+    {
+        _vec_rec_vertices.push_back(GLVertex2f(pts[indices[i]], _cur_color));
+    }
+
+    // merge into the previous range if both are lists of the same primitive
+    bool isList = (mode == GL_POINTS || mode == GL_LINES || mode == GL_TRIANGLES);
+    if (isList && !_vec_rec_ranges.isEmpty() && _vec_rec_ranges.last().mode == mode)
+    {
+        _vec_rec_ranges.last().count += count;
+    }
+    else
+    {
+        _vec_rec_ranges.push_back(GLBatchRange(mode, first, count));
+    }
+}
+
+bool GLFuncUtils::use_sdf() const
+{
+    return (_sdf_enabled && _sdf_program && _viewport_w > 0 && _viewport_h > 0);
+}
+
+void GLFuncUtils::sdf_lines(GLenum mode, const GLPoint2f *pts, int count)
+{
+    _vec_scratch_sdf_pts.clear();
+
+    if (mode == GL_LINES)
+    {
+        for (int i = 0; i+1 < count; i += 2)
+        {
+            append_sdf_line(pts[i], pts[i+1]);
+        }
+    }
+    else
+    {
+        for (int i = 0; i+1 < count; ++i)
+        {
+            append_sdf_line(pts[i], pts[i+1]);
+        }
+        if (mode == GL_LINE_LOOP && count > 2)
+        {
+            append_sdf_line(pts[count-1], pts[0]);
+        }
+    }
+
+    submit_sdf_vertices(_vec_scratch_sdf_pts.constData(), _vec_scratch_sdf_pts.size());
+}
+
+/**
+ * @brief GLFuncUtils::sdf_ellipse
+ * one quad around the ellipse, grown by the anti-aliasing margin
+ * @param ring: the outline only, `sdf_line_half_width` wide
+ */
+void GLFuncUtils::sdf_ellipse(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, bool ring)
+{
+    const float rpx = qMin(qAbs(rx) * _viewport_w, qAbs(ry) * _viewport_h) / 2;
+    if (rpx <= 0) return;
+
+    const float hw = (ring ? sdf_line_half_width : 0);
+    const float kind = (ring ? sdf_ring : sdf_disc);
+    const float m = 1 + (hw + sdf_aa_margin) / rpx;
+
+    const GLPoint2f topLeft(ptCenter.x - rx*m, ptCenter.y + ry*m);
+    const GLPoint2f topRight(ptCenter.x + rx*m, ptCenter.y + ry*m);
+    const GLPoint2f bottomRight(ptCenter.x + rx*m, ptCenter.y - ry*m);
+    const GLPoint2f bottomLeft(ptCenter.x - rx*m, ptCenter.y - ry*m);
+
+    const GLSdfVertex pts[] =
+    {
+        GLSdfVertex(topLeft, _cur_color, -m, m, kind, hw),
+        GLSdfVertex(topRight, _cur_color, m, m, kind, hw),
+        GLSdfVertex(bottomRight, _cur_color, m, -m, kind, hw),
+        GLSdfVertex(topLeft, _cur_color, -m, m, kind, hw),
+        GLSdfVertex(bottomRight, _cur_color, m, -m, kind, hw),
+        GLSdfVertex(bottomLeft, _cur_color, -m, -m, kind, hw)
+    };
+    submit_sdf_vertices(pts, 6);
+}
+
+/**
+ * @brief GLFuncUtils::append_sdf_line
+ * one quad along the segment, as wide as the line and the anti-aliasing margin on both sides,
+ * the width is measured in pixels of the untransformed coordinates
+ */
+void GLFuncUtils::append_sdf_line(const GLPoint2f &pt1, const GLPoint2f &pt2)
+{
+    // gl coordinate to pixel
+    const float sx = _viewport_w / 2.0f;
+    const float sy = _viewport_h / 2.0f;
+
+    const float dx = (pt2.x - pt1.x) * sx;
+    const float dy = (pt2.y - pt1.y) * sy;
+    const float len = sqrt(dx*dx + dy*dy);
+    if (len <= 0) return;
+
+    const float e = sdf_line_half_width + sdf_aa_margin;
+    const float nx = -dy / len * e / sx;
+    const float ny = dx / len * e / sy;
+
+    const GLSdfVertex v1(GLPoint2f(pt1.x + nx, pt1.y + ny), _cur_color, e, 0, sdf_line, sdf_line_half_width);
+    const GLSdfVertex v2(GLPoint2f(pt1.x - nx, pt1.y - ny), _cur_color, -e, 0, sdf_line, sdf_line_half_width);
+    const GLSdfVertex v3(GLPoint2f(pt2.x + nx, pt2.y + ny), _cur_color, e, 0, sdf_line, sdf_line_half_width);
+    const GLSdfVertex v4(GLPoint2f(pt2.x - nx, pt2.y - ny), _cur_color, -e, 0, sdf_line, sdf_line_half_width);
+
+    _vec_scratch_sdf_pts << v1 << v2 << v3 << v3 << v2 << v4;
+}
+
+void GLFuncUtils::submit_sdf_vertices(const GLSdfVertex *pts, int count)
+{
+    if (count <= 0) return;
+
+    if (_recording_batch != no_batch)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            _vec_rec_sdf_vertices.push_back(pts[i]);
+        }
+        return;
+    }
+
+    const int bytes = count * static_cast<int>(sizeof(GLSdfVertex));
+    reserve_stream_buffer(bytes);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _stream_vbo);
+    glBufferData(GL_ARRAY_BUFFER, _stream_capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, pts);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    draw_sdf_vertices(_stream_sdf_vao, 0, count);
+}
+
+/**
+ * @brief GLFuncUtils::set_sdf_attributes
+ * attributes of GLSdfVertex from the bound array buffer into the bound vertex array
+ */
+void GLFuncUtils::set_sdf_attributes()
+{
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLSdfVertex), nullptr);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GLSdfVertex), reinterpret_cast<const void *>(2 * sizeof(GLfloat)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GLSdfVertex), reinterpret_cast<const void *>(6 * sizeof(GLfloat)));
+}
 
+void GLFuncUtils::draw_sdf_vertices(GLuint vao, int first, int count)
+{
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _sdf_program->bind();
 
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, first, count);
+    ++_draw_calls;
+    glBindVertexArray(0);
+
+    _sdf_program->release();
+    glDisable(GL_BLEND);
+}
+
+/**
+ * @brief GLFuncUtils::begin_time_query
+ * @return the query to poll with `time_query_result`, give it back with `recycle_time_query`
+ */
+GLuint GLFuncUtils::begin_time_query()
+{
+    GLuint query = 0;
+    if (_vec_free_time_queries.isEmpty())
+    {
+        glGenQueries(1, &query);
+        _vec_time_queries.push_back(query);
+    }
+    else
+    {
+        query = _vec_free_time_queries.takeLast();
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    return query;
+}
+
+void GLFuncUtils::end_time_query()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+/**
+ * @brief GLFuncUtils::time_query_result
+ * never stalls the pipeline
+ * @return false if the gpu has not finished the commands of the query yet
+ */
+bool GLFuncUtils::time_query_result(GLuint query, qint64 &ns)
+{
+    GLint available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    ns = static_cast<qint64>(elapsed);
+
+    return true;
+}
+
+void GLFuncUtils::recycle_time_query(GLuint query)
+{
+    _vec_free_time_queries.push_back(query);
+}
+
+void GLFuncUtils::release_time_queries()
+{
+    if (!_vec_time_queries.isEmpty())
+    {
+        glDeleteQueries(_vec_time_queries.size(), _vec_time_queries.constData());
+    }
+
+    _vec_time_queries.clear();
+    _vec_free_time_queries.clear();
+}
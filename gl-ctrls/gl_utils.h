@@ -7,10 +7,18 @@
 #include <QRectF>
 #include <QPainter>
 
-// pay attention to the sequence of `<gl/GL.h>`
+// pay attention to the sequence of `<gl/GL.h>`, elsewhere `<GL/gl.h>` comes in through the qt opengl headers
 #include <qopenglfunctions_4_5_compatibility.h>
+#ifdef Q_OS_WIN
 #include <gl/GL.h>
+#endif
 #include <QOpenGLTexture>
+#include <QOpenGLShaderProgram>
+#include <QHash>
+
+#include "gl_glyph_atlas.h"
+
+class ViewportTransform;
 
 
 #define DROP_ABNORMAL_DATA(data)   do { if (abs(data) > 100000) return; } while (0)
@@ -77,11 +85,133 @@ struct GLColor4f
     {}
 };
 
+/**
+ * @brief The GLVertex2f struct
+ * interleaved vertex of retained batches, color is baked per vertex
+ */
+struct GLVertex2f
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat r;
+    GLfloat g;
+    GLfloat b;
+    GLfloat a;
+
+    GLVertex2f(const GLPoint2f &pt = GLPoint2f(), const GLColor4f &cl = GLColor4f())
+        : x(pt.x), y(pt.y), r(cl.r), g(cl.g), b(cl.b), a(cl.a)
+    {}
+};
+
+/**
+ * @brief The GLTexVertex2f struct
+ * interleaved vertex of streamed textured polygons
+ */
+struct GLTexVertex2f
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat s;
+    GLfloat t;
+
+    GLTexVertex2f(GLfloat tmpX = 0, GLfloat tmpY = 0, GLfloat tmpS = 0, GLfloat tmpT = 0)
+        : x(tmpX), y(tmpY), s(tmpS), t(tmpT)
+    {}
+};
+
+/**
+ * @brief The GLSdfVertex struct
+ * vertex of an analytic shape, the fragment shader turns u/v into coverage
+ * kind: 0 disc, 1 ring, 2 line, 3 triangle
+ * disc, ring: u/v on the unit circle
+ * line: u the signed pixel distance across the line
+ * triangle: u/v the first two barycentric coordinates
+ * param: half line width in pixels of rings and lines
+ */
+struct GLSdfVertex
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat r;
+    GLfloat g;
+    GLfloat b;
+    GLfloat a;
+    GLfloat u;
+    GLfloat v;
+    GLfloat kind;
+    GLfloat param;
+
+    GLSdfVertex(const GLPoint2f &pt = GLPoint2f(), const GLColor4f &cl = GLColor4f(),
+                GLfloat tmpU = 0, GLfloat tmpV = 0, GLfloat tmpKind = 0, GLfloat tmpParam = 0)
+        : x(pt.x), y(pt.y), r(cl.r), g(cl.g), b(cl.b), a(cl.a), u(tmpU), v(tmpV), kind(tmpKind), param(tmpParam)
+    {}
+};
+
+/**
+ * @brief The GLBatchRange struct
+ * one draw call of a batch
+ */
+struct GLBatchRange
+{
+    GLenum  mode;
+    GLint   first;
+    GLsizei count;
+
+    GLBatchRange(GLenum tmpMode = GL_TRIANGLES, GLint tmpFirst = 0, GLsizei tmpCount = 0)
+        : mode(tmpMode), first(tmpFirst), count(tmpCount)
+    {}
+};
+
+/**
+ * @brief The GLBatch struct
+ * static geometry uploaded once, drawn with one call per range
+ */
+struct GLBatch
+{
+    GLuint  vao;
+    GLuint  vbo;
+
+    QVector<GLBatchRange>   ranges;
+
+    // analytic shapes, drawn after the ranges in one call
+    GLuint  sdf_vao;
+    GLuint  sdf_vbo;
+    GLsizei sdf_count;
+
+    int     bytes;
+
+    GLBatch()
+        : vao(0), vbo(0), sdf_vao(0), sdf_vbo(0), sdf_count(0), bytes(0)
+    {}
+};
+
+/**
+ * @brief The GLMarkerInstance struct
+ * one triangle marker of an instanced draw
+ * angle: counterclockwise rotation in radian
+ * shape: index of the shape set by `set_marker_shape`
+ */
+struct GLMarkerInstance
+{
+    GLfloat x;
+    GLfloat y;
+    GLfloat angle;
+    GLfloat shape;
+
+    GLMarkerInstance(const GLPoint2f &pt = GLPoint2f(), GLfloat tmpAngle = 0, int tmpShape = 0)
+        : x(pt.x), y(pt.y), angle(tmpAngle), shape(static_cast<GLfloat>(tmpShape))
+    {}
+};
+
 /**
  * @brief classes
  */
 class GLFuncUtils : protected QOpenGLFunctions_4_5_Compatibility
 {
+public:
+    GLFuncUtils();
+    virtual ~GLFuncUtils();
+
 public:
     QPointF gl_point_2_qpointf(const GLPoint2f &pt, const QRect &rcViewPort);
     GLPoint2f qpointf_2_gl_point(const QPointF &pt, const QRect &rcViewPort);
@@ -109,12 +239,14 @@ public:
     void gl_clear_qcolor(const QColor &cl);
     void gl_clear_color3f(const GLColor3f &cl);
     void gl_clear_color4f(const GLColor4f &cl);
+    void clear_color_buffer(const GLColor3f &cl);
 
 public:
     void draw_point(const GLPoint2f &pt);
     void draw_line(const GLPoint2f &pt1, const GLPoint2f &pt2);
     void draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode);
     void draw_triangle(const QVector<GLPoint2f> &vecPts);
+    void draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle);
     void draw_rect(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight);
     void draw_polygon(const QVector<GLPoint2f> &vecPts);
     void draw_ellipse(const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight, GLenum mode = GL_POLYGON);
@@ -124,10 +256,136 @@ public:
     void draw_text(QPainter &p, const QRect &rcViewPort, const GLPoint2f &ptTopLeft, const QString &text);
     void draw_text(QPainter &p, const QRect &rcViewPort, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
                    int flags, const QString &text);
+    void draw_text(GLGlyphFont &glyphFont, const QRect &rcViewPort, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                   int flags, const QString &text);
+    void draw_text(GLGlyphFont &glyphFont, const ViewportTransform &transform, const GLPoint2f &ptTopLeft,
+                   const GLPoint2f &ptBottomRight, int flags, const QString &text);
 
 public:
     void reset_color();
 
+    int draw_call_count() const;
+    void reset_draw_call_count();
+
+public:
+    // tessellation, segment counts follow the on-screen size
+    void set_viewport_size(int w, int h);
+    int ellipse_segments(GLfloat rx, GLfloat ry) const;
+    void ellipse_vertices(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, QVector<GLPoint2f> &vecPts) const;
+
+public:
+    // retained mode, the context must be current
+    void init_gl_buffers();
+    void release_gl_buffers();
+
+    void begin_batch(int id);
+    void end_batch();
+    bool draw_batch(int id);
+    bool has_batch(int id) const;
+    void invalidate_batch(int id);
+    void invalidate_batches();
+
+    // anti-aliased circles, rings, lines and triangles without multisampling, needs `set_viewport_size`
+    void set_sdf_shapes(bool b);
+    bool sdf_shapes() const;
+
+    // bytes of the buffers created by GLFuncUtils
+    qint64 buffer_bytes() const;
+
+    // instanced triangle markers in the current color
+    void set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts);
+    void draw_markers(const QVector<GLMarkerInstance> &vecInstances);
+
+    // polyline ring in a persistently mapped buffer (gl 4.4 or ARB_buffer_storage, `glBufferSubData` without),
+    // x/y in any unit scaled by `draw_trail`, z the time of the vertex
+    void init_trail_buffer(int capacity);
+    void release_trail_buffer();
+    void wait_trail_fence();
+    void write_trail_vertices(int slot, const GLPoint3f *pts, int count);
+    void set_trail_indices(const QVector<quint32> &vecIndices);
+    void draw_trail(GLfloat scale, GLfloat clip, GLfloat now, GLfloat duration, int tailSlot, int tailCount);
+
+    // GL_TIME_ELAPSED queries from a pool, they do not nest, the results are polled without waiting
+    GLuint begin_time_query();
+    void end_time_query();
+    bool time_query_result(GLuint query, qint64 &ns);
+    void recycle_time_query(GLuint query);
+    void release_time_queries();
+
+private:
+    void submit_vertices(GLenum mode, const GLPoint2f *pts, int count);
+    void record_vertices(GLenum mode, const GLPoint2f *pts, int count);
+    void stream_vertices(GLenum mode, const GLPoint2f *pts, int count);
+    void stream_tex_vertices(GLenum mode, const GLTexVertex2f *pts, int count);
+    void submit_tex_vertices(GLenum mode, const GLTexVertex2f *pts, int count);
+    void reserve_stream_buffer(int bytes);
+
+    void append_batch_range(GLenum mode, const GLPoint2f *pts, const int *indices, int count);
+
+    bool use_sdf() const;
+    void sdf_lines(GLenum mode, const GLPoint2f *pts, int count);
+    void sdf_ellipse(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, bool ring);
+    void append_sdf_line(const GLPoint2f &pt1, const GLPoint2f &pt2);
+    void submit_sdf_vertices(const GLSdfVertex *pts, int count);
+    void set_sdf_attributes();
+    void draw_sdf_vertices(GLuint vao, int first, int count);
+
+private:
+    GLColor4f   _cur_color;
+
+    int         _viewport_w;
+    int         _viewport_h;
+
+    // streamed geometry
+    GLuint      _stream_vao;
+    GLuint      _stream_tex_vao;
+    GLuint      _stream_sdf_vao;
+    GLuint      _stream_vbo;
+    int         _stream_capacity;
+
+    // static geometry
+    int         _recording_batch;
+
+    QVector<GLVertex2f>     _vec_rec_vertices;
+    QVector<GLBatchRange>   _vec_rec_ranges;
+    QVector<int>            _vec_rec_indices;
+    QVector<GLPoint2f>      _vec_scratch_pts;
+    QVector<GLTexVertex2f>  _vec_scratch_tex_pts;
+    QVector<QPointF>        _vec_scratch_pixel_pts;
+    QVector<GLSdfVertex>    _vec_rec_sdf_vertices;
+    QVector<GLSdfVertex>    _vec_scratch_sdf_pts;
+
+    QHash<int, GLBatch>     _hash_batches;
+
+    // analytic shapes
+    QOpenGLShaderProgram    *_sdf_program;
+    bool        _sdf_enabled;
+
+    // instanced markers
+    QOpenGLShaderProgram    *_marker_program;
+    GLuint      _marker_vao;
+    GLuint      _marker_corner_vbo;
+    GLuint      _marker_instance_vbo;
+    int         _marker_instance_capacity;
+
+    GLPoint2f   _marker_shapes[6];
+
+    // trail ring
+    QOpenGLShaderProgram    *_trail_program;
+    GLuint      _trail_vao;
+    GLuint      _trail_vbo;
+    GLuint      _trail_ibo;
+    GLPoint3f   *_trail_mapped;
+    GLsync      _trail_fence;       // after the last draw of the mapped ring, the ring is written once it has passed
+    int         _trail_capacity;
+    int         _trail_index_count;
+
+    // timer queries
+    QVector<GLuint>     _vec_time_queries;
+    QVector<GLuint>     _vec_free_time_queries;
+
+    int         _draw_calls;
+
 };
 
 #endif // GL_UTILS_H
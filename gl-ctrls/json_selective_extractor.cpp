@@ -0,0 +1,530 @@
+#include "json_selective_extractor.h"
+
+#include <cstring>
+
+
+static const int max_exponent = 9999;
+static const int max_fast_exponent = 22;
+static const quint64 max_fast_mantissa = (quint64(1) << 53);
+
+// powers of ten exactly representable as double
+static const double exact_pow10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static inline bool is_digit(char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+
+JsonSelectiveExtractor::JsonSelectiveExtractor()
+    : _data(nullptr), _size(0), _pos(0)
+{
+    clear();
+}
+
+void JsonSelectiveExtractor::clear()
+{
+    Node root;
+    root.slot = -1;
+
+    _nodes.clear();
+    _nodes.push_back(root);
+    _slots.clear();
+}
+
+/**
+ * @brief JsonSelectiveExtractor::add_path
+ * @param path: object keys from the root, the same path always gets the same slot
+ * @return slot of the path
+ */
+int JsonSelectiveExtractor::add_path(const QStringList &path)
+{
+    int node = 0;
+    for (const auto &subPath : path)
+    {
+        const auto key = subPath.toUtf8();
+
+        int kid = -1;
+        for (auto k : _nodes.at(node).kids)
+        {
+            if (_nodes.at(k).key == key)
+            {
+                kid = k;
+                break;
+            }
+        }
+
+        if (kid < 0)
+        {
+            Node n;
+            n.key = key;
+            n.slot = -1;
+
+            kid = _nodes.size();
+            _nodes.push_back(n);
+            _nodes[node].kids.push_back(kid);
+        }
+
+        node = kid;
+    }
+
+    if (_nodes.at(node).slot < 0)
+    {
+        Slot s;
+        s.type = Missing;
+        s.number = 0;
+        s.begin = 0;
+        s.end = 0;
+
+        _nodes[node].slot = _slots.size();
+        _slots.push_back(s);
+    }
+
+    return _nodes.at(node).slot;
+}
+
+int JsonSelectiveExtractor::slot_count() const
+{
+    return _slots.size();
+}
+
+bool JsonSelectiveExtractor::extract(const QByteArray &raw)
+{
+    return extract(raw.constData(), raw.size());
+}
+
+/**
+ * @brief JsonSelectiveExtractor::extract
+ * @return false if the json is malformed, the slots filled before the error are kept
+ */
+bool JsonSelectiveExtractor::extract(const char *data, int size)
+{
+    for (auto &s : _slots)
+    {
+        s.type = Missing;
+    }
+
+    _data = data;
+    _size = size;
+    _pos = 0;
+
+    return parse_value(0);
+}
+
+JsonSelectiveExtractor::ValueType JsonSelectiveExtractor::type(int slot) const
+{
+    return _slots.at(slot).type;
+}
+
+double JsonSelectiveExtractor::number(int slot) const
+{
+    return _slots.at(slot).number;
+}
+
+bool JsonSelectiveExtractor::boolean(int slot) const
+{
+    return (_slots.at(slot).number != 0);
+}
+
+bool JsonSelectiveExtractor::string_equals(int slot, const QByteArray &s) const
+{
+    const auto &sl = _slots.at(slot);
+    if (sl.type != String) return false;
+
+    return key_equals(sl.begin, sl.end, s);
+}
+
+bool JsonSelectiveExtractor::parse_value(int node)
+{
+    skip_ws();
+    if (at_end()) return false;
+
+    const bool hasKids = !_nodes.at(node).kids.isEmpty();
+    const int slot = _nodes.at(node).slot;
+
+    // not subscribed, nothing below is subscribed either
+    if (!hasKids && slot < 0) return skip_value();
+
+    const int begin = _pos;
+    int strBegin = begin;
+    int strEnd = begin;
+    ValueType type = Compound;
+    double d = 0;
+    bool ok = true;
+
+    switch (_data[_pos])
+    {
+    case '{':
+        ok = (hasKids ? parse_object(node) : skip_value());
+        break;
+    case '[':
+        ok = skip_value();
+        break;
+    case '"':
+        type = String;
+        ok = parse_string(strBegin, strEnd);
+        break;
+    case 't':
+        type = Bool;
+        d = 1;
+        ok = parse_literal("true");
+        break;
+    case 'f':
+        type = Bool;
+        ok = parse_literal("false");
+        break;
+    case 'n':
+        type = Null;
+        ok = parse_literal("null");
+        break;
+    default:
+        type = Number;
+        ok = parse_number(d);
+        break;
+    }
+
+    if (!ok) return false;
+
+    if (slot >= 0)
+    {
+        auto &s = _slots[slot];
+        s.type = type;
+        s.number = d;
+        s.begin = (type == String ? strBegin : begin);
+        s.end = (type == String ? strEnd : _pos);
+    }
+
+    return true;
+}
+
+bool JsonSelectiveExtractor::parse_object(int node)
+{
+    // skip '{'
+    ++_pos;
+
+    skip_ws();
+    if (at_end()) return false;
+    if (_data[_pos] == '}')
+    {
+        ++_pos;
+        return true;
+    }
+
+    for (;;)
+    {
+        int keyBegin, keyEnd;
+
+        skip_ws();
+        if (at_end() || _data[_pos] != '"' || !parse_string(keyBegin, keyEnd)) return false;
+
+        skip_ws();
+        if (at_end() || _data[_pos] != ':') return false;
+        ++_pos;
+
+        const int kid = match_kid(node, keyBegin, keyEnd);
+        if (!(kid >= 0 ? parse_value(kid) : skip_value())) return false;
+
+        skip_ws();
+        if (at_end()) return false;
+
+        if (_data[_pos] == ',')
+        {
+            ++_pos;
+            continue;
+        }
+
+        if (_data[_pos] == '}')
+        {
+            ++_pos;
+            return true;
+        }
+
+        return false;
+    }
+}
+
+/**
+ * @brief JsonSelectiveExtractor::parse_string
+ * @param begin: first byte after the opening quote
+ * @param end: the closing quote, escapes are kept as they are
+ */
+bool JsonSelectiveExtractor::parse_string(int &begin, int &end)
+{
+    // skip '"'
+    ++_pos;
+    begin = _pos;
+
+    while (_pos < _size)
+    {
+        const char c = _data[_pos];
+        if (c == '\\')
+        {
+            _pos += 2;
+            continue;
+        }
+
+        if (c == '"')
+        {
+            end = _pos;
+            ++_pos;
+            return true;
+        }
+
+        ++_pos;
+    }
+
+    return false;
+}
+
+/**
+ * @brief JsonSelectiveExtractor::parse_number
+ * locale independent and correctly rounded, up to 15 significant digits with small exponents
+ * are exact in doubles, any other number goes through the conversion `QJsonDocument` uses
+ */
+bool JsonSelectiveExtractor::parse_number(double &d)
+{
+    const int start = _pos;
+
+    bool neg = false;
+    if (_pos < _size && _data[_pos] == '-')
+    {
+        neg = true;
+        ++_pos;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool anyDigit = false;
+
+    // integer part, digits beyond the 19th only scale
+    while (_pos < _size && is_digit(_data[_pos]))
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<quint64>(_data[_pos] - '0');
+            if (mantissa != 0) ++digits;
+        }
+        else
+        {
+            ++exp10;
+        }
+
+        anyDigit = true;
+        ++_pos;
+    }
+    if (!anyDigit) return false;
+
+    // fraction part
+    if (_pos < _size && _data[_pos] == '.')
+    {
+        ++_pos;
+        while (_pos < _size && is_digit(_data[_pos]))
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<quint64>(_data[_pos] - '0');
+                if (mantissa != 0) ++digits;
+                --exp10;
+            }
+
+            ++_pos;
+        }
+    }
+
+    // exponent part
+    if (_pos < _size && (_data[_pos] == 'e' || _data[_pos] == 'E'))
+    {
+        ++_pos;
+
+        int sign = 1;
+        if (_pos < _size && (_data[_pos] == '+' || _data[_pos] == '-'))
+        {
+            sign = (_data[_pos] == '-' ? -1 : 1);
+            ++_pos;
+        }
+
+        int e = 0;
+        bool anyExpDigit = false;
+        while (_pos < _size && is_digit(_data[_pos]))
+        {
+            if (e < max_exponent) e = e * 10 + (_data[_pos] - '0');
+            anyExpDigit = true;
+            ++_pos;
+        }
+        if (!anyExpDigit) return false;
+
+        exp10 += sign * e;
+    }
+
+    // mantissa and power of ten are both exact, so one rounding step, beyond the 19th digit
+    // the mantissa is past 2^53 and never takes this path
+    if (mantissa < max_fast_mantissa && exp10 >= -max_fast_exponent && exp10 <= max_fast_exponent)
+    {
+        double v = static_cast<double>(mantissa);
+        v = (exp10 < 0 ? v / exact_pow10[-exp10] : v * exact_pow10[exp10]);
+        d = (neg ? -v : v);
+        return true;
+    }
+
+    // mantissa times pow(10, exp10) would round twice, convert the whole text instead,
+    // so both ingestion paths of the cards see the same double
+    bool ok = false;
+    d = QByteArray::fromRawData(_data + start, _pos - start).toDouble(&ok);
+    return ok;
+}
+
+bool JsonSelectiveExtractor::parse_literal(const char *lit)
+{
+    const int len = static_cast<int>(strlen(lit));
+    if (_size - _pos < len || memcmp(_data + _pos, lit, static_cast<size_t>(len)) != 0) return false;
+
+    _pos += len;
+    return true;
+}
+
+/**
+ * @brief JsonSelectiveExtractor::skip_value
+ * skip any value without looking into it, nested containers are skipped by depth counting
+ */
+bool JsonSelectiveExtractor::skip_value()
+{
+    skip_ws();
+    if (at_end()) return false;
+
+    int strBegin, strEnd;
+    const char c = _data[_pos];
+
+    if (c == '"') return parse_string(strBegin, strEnd);
+    if (c == 't') return parse_literal("true");
+    if (c == 'f') return parse_literal("false");
+    if (c == 'n') return parse_literal("null");
+
+    if (c != '{' && c != '[')
+    {
+        double d;
+        return parse_number(d);
+    }
+
+    int depth = 0;
+    while (_pos < _size)
+    {
+        const char cur = _data[_pos];
+        if (cur == '"')
+        {
+            if (!parse_string(strBegin, strEnd)) return false;
+            continue;
+        }
+
+        ++_pos;
+        if (cur == '{' || cur == '[')
+        {
+            ++depth;
+        }
+        else if (cur == '}' || cur == ']')
+        {
+            if (--depth == 0) return true;
+        }
+    }
+
+    return false;
+}
+
+int JsonSelectiveExtractor::match_kid(int node, int begin, int end) const
+{
+    for (auto kid : _nodes.at(node).kids)
+    {
+        if (key_equals(begin, end, _nodes.at(kid).key)) return kid;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief JsonSelectiveExtractor::key_equals
+ * compare raw string bytes with a utf-8 key, simple escapes and ascii \\u escapes are decoded
+ */
+bool JsonSelectiveExtractor::key_equals(int begin, int end, const QByteArray &key) const
+{
+    const char *raw = _data + begin;
+    const int len = end - begin;
+
+    // fast path, no escape
+    if (len == key.size() && memcmp(raw, key.constData(), static_cast<size_t>(len)) == 0) return true;
+    if (!memchr(raw, '\\', static_cast<size_t>(len))) return false;
+
+    int k = 0;
+    for (int i = begin; i < end; ++i)
+    {
+        char c = _data[i];
+        if (c == '\\')
+        {
+            if (++i >= end) return false;
+
+            switch (_data[i])
+            {
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u':
+            {
+                if (i + 4 >= end) return false;
+
+                int u = 0;
+                for (int j = 1; j <= 4; ++j)
+                {
+                    const int h = hex_value(_data[i + j]);
+                    if (h < 0) return false;
+                    u = u * 16 + h;
+                }
+
+                // non ascii escapes never match
+                if (u > 0x7f) return false;
+
+                c = static_cast<char>(u);
+                i += 4;
+                break;
+            }
+            default:
+                c = _data[i];
+                break;
+            }
+        }
+
+        if (k >= key.size() || key.at(k) != c) return false;
+        ++k;
+    }
+
+    return (k == key.size());
+}
+
+void JsonSelectiveExtractor::skip_ws()
+{
+    while (_pos < _size)
+    {
+        const char c = _data[_pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return;
+
+        ++_pos;
+    }
+}
+
+bool JsonSelectiveExtractor::at_end() const
+{
+    return (_pos >= _size);
+}
@@ -0,0 +1,85 @@
+#ifndef JSON_SELECTIVE_EXTRACTOR_H
+#define JSON_SELECTIVE_EXTRACTOR_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+
+/**
+ * @brief The JsonSelectiveExtractor class
+ * pull the values of a fixed set of paths out of raw json in one pass,
+ * without building a document, everything else is skipped byte by byte,
+ * nothing is allocated by `extract` once the paths are added
+ */
+class JsonSelectiveExtractor
+{
+public:
+    enum ValueType
+    {
+        Missing,
+        Null,
+        Bool,
+        Number,
+        String,
+        Compound    // object or array, kept as raw bytes
+    };
+
+public:
+    JsonSelectiveExtractor();
+
+    void clear();
+    int add_path(const QStringList &path);
+    int slot_count() const;
+
+    bool extract(const QByteArray &raw);
+    bool extract(const char *data, int size);
+
+    // valid until the next `extract`, string data points into the extracted buffer
+    ValueType type(int slot) const;
+    double number(int slot) const;
+    bool boolean(int slot) const;
+    bool string_equals(int slot, const QByteArray &s) const;
+
+private:
+    struct Node
+    {
+        QByteArray      key;
+        int             slot;
+        QVector<int>    kids;
+    };
+
+    struct Slot
+    {
+        ValueType   type;
+        double      number;
+        int         begin;
+        int         end;
+    };
+
+private:
+    bool parse_value(int node);
+    bool parse_object(int node);
+    bool parse_array();
+    bool parse_string(int &begin, int &end);
+    bool parse_number(double &d);
+    bool parse_literal(const char *lit);
+    bool skip_value();
+
+    int match_kid(int node, int begin, int end) const;
+    bool key_equals(int begin, int end, const QByteArray &key) const;
+
+    void skip_ws();
+    bool at_end() const;
+
+private:
+    QVector<Node>   _nodes;
+    QVector<Slot>   _slots;
+
+    const char      *_data;
+    int             _size;
+    int             _pos;
+
+};
+
+#endif // JSON_SELECTIVE_EXTRACTOR_H
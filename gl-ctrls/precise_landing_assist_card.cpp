@@ -2,11 +2,29 @@
 
 #include "aosk_algorithms_export_global.h"
 
+#include <QJsonDocument>
+#include <QPointer>
+
 
 namespace solo
 {
 
-QHash<QString, PreciseLandingAssistCard::set_func> PreciseLandingAssistCard::hash_name_func;
+QHash<QString, set_func> PreciseLandingAssistCard::hash_name_func;
+
+
+static UriTrieNode &uri_trie_kid(UriTrieNode &node, const QString &key)
+{
+    for (auto &kid : node.kids)
+    {
+        if (kid.key == key) return kid;
+    }
+
+    UriTrieNode kid;
+    kid.key = key;
+    node.kids.push_back(kid);
+
+    return node.kids.last();
+}
 
 
 PreciseLandingAssistCard::PreciseLandingAssistCard(QWidget *parent)
@@ -21,6 +39,7 @@ PreciseLandingAssistCard::PreciseLandingAssistCard(QWidget *parent)
 
 PreciseLandingAssistCard::~PreciseLandingAssistCard()
 {
+    RenderScheduler::instance()->unregister_widget(this);
     DELETE_Q_POINTER(_ctrl);
 }
 
@@ -38,6 +57,7 @@ void PreciseLandingAssistCard::set_card_struct_data(eqnx_dh::CardContentItem *ca
 {
     // Clear container
     _hash_name_uris.clear();
+    _uri_trie = UriTrieNode();
 
     // Parse json
     if (!cardContentItem) return;
@@ -63,22 +83,70 @@ void PreciseLandingAssistCard::set_card_struct_data(eqnx_dh::CardContentItem *ca
             _hash_name_uris.insert(varDef->name(), listUris);
         }
     }
+
+    compile_uri_trie();
+    compile_extractor();
 }
 
+/**
+ * @brief PreciseLandingAssistCard::replay_sink
+ * a card deleted while playing is skipped from then on
+ */
+TelemetryReplayer::sink_func PreciseLandingAssistCard::replay_sink(const QHash<QString, PreciseLandingAssistCard *> &hashCards)
+{
+    QHash<QString, QPointer<PreciseLandingAssistCard>> hashPtrs;
+    for (auto it = hashCards.constBegin(); it != hashCards.constEnd(); ++it)
+    {
+        hashPtrs.insert(it.key(), it.value());
+    }
+
+    return [hashPtrs](const QString &idsn, const QByteArray &msg)
+    {
+        auto card = hashPtrs.value(idsn);
+        if (!card) return;
+
+        card->set_state_data(msg);
+    };
+}
+
+/**
+ * @brief PreciseLandingAssistCard::set_state_data
+ * resolve every subscribed field in one traversal of the trie, each json node is visited once
+ * @param jo
+ */
 void PreciseLandingAssistCard::set_state_data(const QJsonObject &jo)
 {
-    for (auto name : _hash_name_uris.keys())
+    auto recorder = TelemetryRecorder::instance();
+    if (recorder->is_recording()) recorder->record(_idsn, QJsonDocument(jo).toJson(QJsonDocument::Compact));
+
+    // try to match pack alias
+    auto packAlias = jo.value(str_pack_alias).toString();
+    for (const auto &node : _uri_trie.kids)
     {
-        // get data
-        auto uri = _hash_name_uris.value(name);
-        auto data = parse_data_by_uri(jo, uri);
-        if (data.isNull()) continue;
+        if (node.key != packAlias) continue;
+
+        apply_uri_node(node, jo.value(str_states));
+        break;
+    }
+}
+
+/**
+ * @brief PreciseLandingAssistCard::set_state_data
+ * pull the subscribed numbers straight out of the raw message, without parsing it into a QJsonObject
+ * @param raw: utf-8 json of one state message
+ */
+void PreciseLandingAssistCard::set_state_data(const QByteArray &raw)
+{
+    TelemetryRecorder::instance()->record(_idsn, raw);
 
-        // call function to set data
-        if (!hash_name_func.contains(name)) continue;
+    if (!_extractor.extract(raw)) return;
 
-        auto func = hash_name_func.value(name);
-        func(this, data);
+    for (const auto &setter : _vec_slot_setters)
+    {
+        if (!_extractor.string_equals(_pack_alias_slot, setter.pack_alias)) continue;
+        if (_extractor.type(setter.slot) != JsonSelectiveExtractor::Number) continue;
+
+        setter.func(this, QJsonValue(_extractor.number(setter.slot)));
     }
 }
 
@@ -87,6 +155,21 @@ QStringList PreciseLandingAssistCard::uri_roots() const
     return _list_uri_roots;
 }
 
+void PreciseLandingAssistCard::set_host(PreciseLandingAssistHost *host)
+{
+    if (host == _host) return;
+
+    if (_host) _host->remove_ctrl(_ctrl);
+
+    _host = host;
+    if (_host) _host->add_ctrl(_ctrl, this);
+}
+
+PreciseLandingAssistHost *PreciseLandingAssistCard::host() const
+{
+    return _host;
+}
+
 void PreciseLandingAssistCard::set_platform_longitude(const QJsonValue &val)
 {
     DROP_ABNORMAL_DATA(val.toDouble());
@@ -127,7 +210,10 @@ void PreciseLandingAssistCard::init_members()
     _uav_lon = 0;
     _uav_lat = 0;
 
+    _pack_alias_slot = _extractor.add_path(QStringList() << str_pack_alias);
+
     _ctrl = new PreciseLandingAssistCtrl(this);
+    _host = nullptr;
 }
 
 void PreciseLandingAssistCard::init_ui()
@@ -143,10 +229,11 @@ void PreciseLandingAssistCard::init_signal_slots()
 
 void PreciseLandingAssistCard::init_timers()
 {
-    connect(&_tm_update, &QTimer::timeout, this, &PreciseLandingAssistCard::tm_update_slot);
-
-    _tm_update.setInterval(1000 / 10);
-    _tm_update.start();
+    // ticked by the shared scheduler, not while the card is hidden
+    RenderScheduler::instance()->register_widget(this, [this]()
+    {
+        tm_update_slot();
+    }, 1000 / 10);
 }
 
 void PreciseLandingAssistCard::resizeEvent(QResizeEvent *e)
@@ -169,49 +256,107 @@ void PreciseLandingAssistCard::mouseMoveEvent(QMouseEvent *e)
     this->move(pt);
 }
 
-GLPoint2f PreciseLandingAssistCard::calc_uav_pos() const
+/**
+ * @brief PreciseLandingAssistCard::wheelEvent
+ * only reached while hosted, otherwise the ctrl covers the card and takes the wheel itself
+ */
+void PreciseLandingAssistCard::wheelEvent(QWheelEvent *e)
+{
+    _ctrl->zoom(e->delta() > 0 ? 1 : -1);
+}
+
+/**
+ * @brief PreciseLandingAssistCard::calc_uav_pos
+ * range and bearing from the platform to the uav, published to the ctrl
+ */
+void PreciseLandingAssistCard::calc_uav_pos()
 {
-    GLPoint2f pt;
+    // the trigonometry of the platform is reused until it moves
+    if (_platform_lon != _geodesy.origin_lon() || _platform_lat != _geodesy.origin_lat())
+    {
+        _geodesy.set_origin(_platform_lon, _platform_lat);
+    }
 
-//    aos::AlgorithmsKdtreeUtilities::lonlat_distance();
-//    lonlat_direction();
+    auto rb = _geodesy.range_bearing(_uav_lon, _uav_lat);
 
-    return pt;
+    // the ctrl turns counterclockwise from the north
+    auto st = _ctrl->state();
+    st.distance = rb.distance;
+    st.direction = -rb.bearing;
+    _ctrl->publish_state(st);
 }
 
 /**
- * @brief PreciseLandingAssistCard::parse_data_by_uri
- * @param jo
- * @param uri
- * @return
+ * @brief PreciseLandingAssistCard::compile_uri_trie
+ * merge the uris of the fields with a setter into `_uri_trie`, shared prefixes are walked once
  */
-QJsonValue PreciseLandingAssistCard::parse_data_by_uri(const QJsonObject &jo, QStringList &uri)
+void PreciseLandingAssistCard::compile_uri_trie()
 {
-    // try to match pack alias
-    auto packAlias = jo.value(str_pack_alias).toString();
-    if (uri.isEmpty() || uri.first() != packAlias)
+    _uri_trie = UriTrieNode();
+
+    for (auto it = _hash_name_uris.constBegin(); it != _hash_name_uris.constEnd(); ++it)
+    {
+        if (it.value().isEmpty() || !hash_name_func.contains(it.key())) continue;
+
+        auto node = &_uri_trie;
+        for (const auto &subUri : it.value())
+        {
+            node = &uri_trie_kid(*node, subUri);
+        }
+
+        node->funcs.push_back(hash_name_func.value(it.key()));
+    }
+}
+
+/**
+ * @brief PreciseLandingAssistCard::compile_extractor
+ * the same subscriptions as `_uri_trie`, as paths of the raw message
+ */
+void PreciseLandingAssistCard::compile_extractor()
+{
+    _extractor.clear();
+    _vec_slot_setters.clear();
+
+    _pack_alias_slot = _extractor.add_path(QStringList() << str_pack_alias);
+
+    for (auto it = _hash_name_uris.constBegin(); it != _hash_name_uris.constEnd(); ++it)
     {
-        return QJsonValue::Null;
+        if (it.value().isEmpty() || !hash_name_func.contains(it.key())) continue;
+
+        auto path = it.value();
+        auto packAlias = path.takeFirst();
+        path.prepend(str_states);
+
+        UriSlotSetter setter;
+        setter.pack_alias = packAlias.toUtf8();
+        setter.slot = _extractor.add_path(path);
+        setter.func = hash_name_func.value(it.key());
+
+        _vec_slot_setters.push_back(setter);
     }
+}
 
-    // operate temperary var
-    uri.pop_front();
+void PreciseLandingAssistCard::apply_uri_node(const UriTrieNode &node, const QJsonValue &val)
+{
+    if (val.isNull() || val.isUndefined()) return;
 
-    // traverse uri
-    auto data = jo.value(str_states);
-    for (auto subUri : uri)
+    for (const auto &func : node.funcs)
     {
-        data = data.toObject().value(subUri);
+        func(this, val);
     }
 
-    return data;
+    if (node.kids.isEmpty() || !val.isObject()) return;
+
+    auto obj = val.toObject();
+    for (const auto &kid : node.kids)
+    {
+        apply_uri_node(kid, obj.value(kid.key));
+    }
 }
 
 void PreciseLandingAssistCard::tm_update_slot()
 {
     calc_uav_pos();
-
-    // to do
 }
 
 
@@ -2,18 +2,46 @@
 #define PreciseLandingAssistCard_H
 
 #include "precise_landing_assist_ctrl.h"
+#include "precise_landing_assist_host.h"
+#include "json_selective_extractor.h"
+#include "geodesy.h"
+#include "telemetry_log.h"
 
 
 namespace solo
 {
 
+class PreciseLandingAssistCard;
+typedef std::function<void (PreciseLandingAssistCard *, const QJsonValue &)>   set_func;
+
+/**
+ * @brief The UriTrieNode struct
+ * subscribed uris compiled into a prefix tree,
+ * key: uri component, the first level is the pack alias
+ * funcs: setters of the fields whose uri ends here
+ */
+struct UriTrieNode
+{
+    QString                 key;
+    QVector<set_func>       funcs;
+    QVector<UriTrieNode>    kids;
+};
+
+/**
+ * @brief The UriSlotSetter struct
+ * setter fed from an extractor slot when the message matches the pack alias
+ */
+struct UriSlotSetter
+{
+    QByteArray      pack_alias;
+    int             slot;
+    set_func        func;
+};
+
 class PreciseLandingAssistCard : public QWidget
 {
     Q_OBJECT
 
-private:
-    typedef std::function<void (PreciseLandingAssistCard *, const QJsonValue &)>   set_func;
-
 public:
     PreciseLandingAssistCard(QWidget *parent = nullptr);
     ~PreciseLandingAssistCard() override;
@@ -23,9 +51,17 @@ public:
 
     void set_card_struct_data(eqnx_dh::CardContentItem *cardContentItem);
     void set_state_data(const QJsonObject &jo);
+    void set_state_data(const QByteArray &raw);
 
     QStringList uri_roots() const;
 
+    // a replayer sink feeding every message to `set_state_data` of the card of its idsn, other idsns are skipped
+    static TelemetryReplayer::sink_func replay_sink(const QHash<QString, PreciseLandingAssistCard *> &hashCards);
+
+    // one host draws many cards in a single pass, the card must be a child of the host, null draws the card itself
+    void set_host(PreciseLandingAssistHost *host);
+    PreciseLandingAssistHost *host() const;
+
     void set_platform_longitude(const QJsonValue &val);
     void set_platform_latitude(const QJsonValue &val);
 
@@ -43,18 +79,22 @@ protected:
     void resizeEvent(QResizeEvent *e) override;
     void mousePressEvent(QMouseEvent *e) override;
     void mouseMoveEvent(QMouseEvent *e) override;
+    void wheelEvent(QWheelEvent *e) override;
 
 private:
-    GLPoint2f calc_uav_pos() const;
+    void calc_uav_pos();
 
 private:
-    QJsonValue parse_data_by_uri(const QJsonObject &jo, QStringList &uri);
+    void compile_uri_trie();
+    void compile_extractor();
+    void apply_uri_node(const UriTrieNode &node, const QJsonValue &val);
 
 private slots:
     void tm_update_slot();
 
 private:
     PreciseLandingAssistCtrl    *_ctrl;
+    PreciseLandingAssistHost    *_host;
 
 private:
     double      _platform_lon;
@@ -64,7 +104,14 @@ private:
 
     QString     _idsn;
 
+    Geodesy     _geodesy;
+
     QHash<QString, QStringList>  _hash_name_uris;
+    UriTrieNode                  _uri_trie;
+
+    JsonSelectiveExtractor       _extractor;
+    int                          _pack_alias_slot;
+    QVector<UriSlotSetter>       _vec_slot_setters;
 
 private:
     // assist vars
@@ -72,7 +119,6 @@ private:
 
     QStringList _list_uri_roots;
 
-    QTimer      _tm_update;
 
 private:
     QPoint      _pt_offset;
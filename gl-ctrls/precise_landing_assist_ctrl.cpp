@@ -1,9 +1,12 @@
 #include "precise_landing_assist_ctrl.h"
 
 #include <QDebug>
-#include <QTimer>
+#include <QElapsedTimer>
 #include <QWheelEvent>
-#include <QMutexLocker>
+#include <QMouseEvent>
+
+#include <chrono>
+#include <cmath>
 
 
 static const double PI = 3.1415926;
@@ -11,12 +14,40 @@ static const double PI = 3.1415926;
 static const int font_pixel_size = 12;
 static const float circle_f = 0.6f;
 static const GLPoint2f pt_center(0, 0);
-static const GLPoint2f pt_top_left(-1*circle_f, 1*circle_f);
-static const GLPoint2f pt_bottom_right(1*circle_f, -1*circle_f);
+static const float tgt_radius = 0.03f;
+
+// the shapes are anti-aliased in the shader by default
+static const int default_msaa_samples = 0;
+
+// pixel, largest deviation of the simplified trail
+static const double trail_tolerance_px = 0.5;
+static const float trail_alpha = 0.8f;
+
+// the fade of the trail is redrawn this many times a duration when nothing else changes
+static const int trail_fade_steps = 64;
+
+// pixel, a marker farther from the cursor is not picked, the grid cells span the whole pick circle
+static const double target_pick_radius_px = 10;
+static const double target_grid_cell_px = 2 * target_pick_radius_px;
+
+// pixel, count badges of the rim chevrons
+static const int rim_badge_font_px = 10;
+
+// second, monotonic
+static double monotonic_time()
+{
+    auto d = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(d).count();
+}
+
+// ids of the static batches, relative to the base of the size they are recorded for
+static const int batch_bg = 0;
+static const int batch_axis = 1;
+static const int batch_tgt = 2;
 
 
 PreciseLandingAssistCtrl::PreciseLandingAssistCtrl(QWidget *parent)
-    : QOpenGLWidget(parent)
+    : QOpenGLWidget(parent), _frame_pipeline([this]() { frame_ready(); }), _gl_backend(this, &_glyph_atlas)
 {
     init_members();
     init_ui();
@@ -27,48 +58,313 @@ PreciseLandingAssistCtrl::PreciseLandingAssistCtrl(QWidget *parent)
 
 PreciseLandingAssistCtrl::~PreciseLandingAssistCtrl()
 {
+    RenderScheduler::instance()->unregister_widget(this);
 
+    if (!_gl_resolved) return;
+
+    makeCurrent();
+    _profiler.release_gl();
+    release_static_layer();
+    _glyph_atlas.release();
+    release_gl_buffers();
+    doneCurrent();
 }
 
+/**
+ * the single field setters modify the last published state,
+ * concurrent producers should publish the whole state with `publish_state`
+ */
 void PreciseLandingAssistCtrl::set_direction(double d)
 {
-    _direction = d;
+    auto st = _state.load();
+    st.direction = d;
+    _state.store(st);
 }
 
 double PreciseLandingAssistCtrl::direction() const
 {
-    return _direction;
+    return _state.load().direction;
 }
 
 void PreciseLandingAssistCtrl::set_distance(double d)
 {
     if (d < 0) return;
 
-    _distance = d;
+    auto st = _state.load();
+    st.distance = d;
+    _state.store(st);
 }
 
 double PreciseLandingAssistCtrl::distance() const
 {
-    return _distance;
+    return _state.load().distance;
 }
 
 void PreciseLandingAssistCtrl::set_uav_angle(double d)
 {
-    _uav_angle = d;
+    auto st = _state.load();
+    st.uav_angle = d;
+    _state.store(st);
 }
 
 double PreciseLandingAssistCtrl::uav_angle() const
 {
-    return _uav_angle;
+    return _state.load().uav_angle;
 }
 
+/**
+ * @brief PreciseLandingAssistCtrl::update_ui
+ * take one consistent snapshot of the published state, call it in the gui thread,
+ * with dead reckoning the predicted state is drawn instead,
+ * a state that shows nothing new is dropped by the update filter before it is calculated
+ */
 void PreciseLandingAssistCtrl::update_ui()
 {
-    QMutexLocker locker(&_mtx);
+    std::uint64_t ver;
+    auto st = _state.load(ver);
+
+    const double t = monotonic_time();
+    const bool isNewSample = (ver != _state_version);
+    _state_version = ver;
+
+    if (isNewSample && _trail_enabled)
+    {
+        add_trail_sample(t, st);
+    }
+
+    if (_dead_reckoning_enabled)
+    {
+        if (isNewSample) _dead_reckoning.add_sample(t, st);
+
+        st = _dead_reckoning.predict(t);
+    }
+
+    if (_update_filter)
+    {
+        const auto vis = calc_visible_state(st, t);
+        const bool same = (vis == _visible_state && !_visible_dirty && !_profiler_overlay);
+        _visible_state = vis;
+
+        // the last drawn state stays, it is the same on the screen,
+        // an invalidated static layer asks for its own repaint
+        if (same)
+        {
+            ++_suppressed_updates;
+            return;
+        }
+    }
+    _visible_dirty = false;
+
+    _distance   = st.distance;
+    _direction  = st.direction;
+    _uav_angle  = st.uav_angle;
 
     calc_members();
+    if (!_geometry_worker) show_frame();
+}
 
-    update();
+/**
+ * @brief PreciseLandingAssistCtrl::tick_prediction
+ * one frame of dead reckoning, ticked by the scheduler, or by the host while the ctrl is hosted
+ */
+void PreciseLandingAssistCtrl::tick_prediction()
+{
+    if (!_dead_reckoning_enabled || _dead_reckoning.is_settled(monotonic_time())) return;
+
+    update_ui();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_host
+ * draw the ctrl in the pass of `host` instead of its own widget, the ctrl is hidden and never creates a context,
+ * null draws it in its own widget again
+ */
+void PreciseLandingAssistCtrl::set_host(QWidget *host)
+{
+    if (host == _host) return;
+
+    _host = host;
+    setVisible(!_host);
+
+    RenderScheduler::instance()->request_update(render_widget());
+}
+
+QWidget *PreciseLandingAssistCtrl::host() const
+{
+    return _host;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::render_hosted
+ * draw the frame with the gl of the host, whose viewport and scissor are set to the area of the ctrl,
+ * the static shapes are shared by the ctrls of one size through the batches of `gl`,
+ * the trail is drawn as lines, the gpu ring lives in the context of the ctrl
+ * @param sz: size of the area
+ */
+void PreciseLandingAssistCtrl::render_hosted(GLFuncUtils &gl, RenderBackend &be, const QSize &sz, int batchBase)
+{
+    calc_hosted_viewport(sz);
+
+    be.begin_frame(sz.width(), sz.height(), _cl_dark_blue);
+    be.set_marker_shape(0, _vec_uav_triangle_pts);
+    be.set_marker_shape(1, _vec_uav_outside_triangle_pts);
+
+    draw_static_shapes(gl, be, batchBase);
+    draw_trail_lines(be);
+    draw_distance_mark(be);
+    draw_targets(be);
+    draw_uav(be);
+
+    be.end_frame();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::render_hosted_image
+ * the host composites the image with a painter, no gl function is called
+ * @param sz: size of the area
+ */
+QImage PreciseLandingAssistCtrl::render_hosted_image(const QSize &sz, qreal dpr)
+{
+    calc_hosted_viewport(sz);
+    set_viewport_size(sz.width(), sz.height());
+
+    return render_image(sz * dpr);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::calc_hosted_viewport
+ * the hosted ctrl is never resized, the area size is its viewport
+ */
+void PreciseLandingAssistCtrl::calc_hosted_viewport(const QSize &sz)
+{
+    if (_viewport_transform.viewport().size() == sz) return;
+
+    _viewport_transform.set_viewport(QRect(QPoint(0, 0), sz));
+    _rim_clusters_stale = true;
+    calc_members();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::zoom
+ * @param steps: radius scale steps, positive zooms out
+ */
+void PreciseLandingAssistCtrl::zoom(int steps)
+{
+    set_radius(_radius + _radius_scale_step * steps);
+}
+
+QWidget *PreciseLandingAssistCtrl::render_widget()
+{
+    return (_host ? _host : this);
+}
+
+const ViewportTransform &PreciseLandingAssistCtrl::viewport_transform() const
+{
+    return _viewport_transform;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::publish_state
+ * publish the whole state from any thread without blocking,
+ * the gui thread is asked for at most one pending `update_ui`
+ * @param st
+ */
+void PreciseLandingAssistCtrl::publish_state(const PreciseLandingState &st)
+{
+    if (st.distance < 0) return;
+
+    _state.store(st);
+
+    if (_update_pending.exchange(true)) return;
+
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        _update_pending = false;
+        update_ui();
+    }, Qt::QueuedConnection);
+}
+
+PreciseLandingState PreciseLandingAssistCtrl::state() const
+{
+    return _state.load();
+}
+
+void PreciseLandingAssistCtrl::set_dead_reckoning(bool b)
+{
+    _dead_reckoning_enabled = b;
+    _dead_reckoning.clear();
+}
+
+bool PreciseLandingAssistCtrl::dead_reckoning() const
+{
+    return _dead_reckoning_enabled;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_prediction_horizon
+ * how long the uav keeps moving after the last sample
+ * @param ms
+ */
+void PreciseLandingAssistCtrl::set_prediction_horizon(int ms)
+{
+    _dead_reckoning.set_horizon(ms / 1000.0);
+}
+
+int PreciseLandingAssistCtrl::prediction_horizon() const
+{
+    return qRound(_dead_reckoning.horizon() * 1000);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_snap_back
+ * how long a new sample takes to replace the prediction, 0 jumps at once
+ * @param ms
+ */
+void PreciseLandingAssistCtrl::set_snap_back(int ms)
+{
+    _dead_reckoning.set_snap_back(ms / 1000.0);
+}
+
+int PreciseLandingAssistCtrl::snap_back() const
+{
+    return qRound(_dead_reckoning.snap_back() * 1000);
+}
+
+void PreciseLandingAssistCtrl::set_trail(bool b)
+{
+    if (b == _trail_enabled) return;
+
+    _trail_enabled = b;
+    clear_trail();
+}
+
+bool PreciseLandingAssistCtrl::trail() const
+{
+    return _trail_enabled;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_trail_duration
+ * how long a sample stays on the trail, fading out on the way,
+ * at most `ApproachTrail::capacity` samples are kept however long it is
+ * @param s
+ */
+void PreciseLandingAssistCtrl::set_trail_duration(int s)
+{
+    _trail.set_duration(s);
+}
+
+int PreciseLandingAssistCtrl::trail_duration() const
+{
+    return qRound(_trail.duration());
+}
+
+void PreciseLandingAssistCtrl::clear_trail()
+{
+    _trail.clear();
+    _trail_uploaded = 0;
+
+    RenderScheduler::instance()->request_update(render_widget());
 }
 
 void PreciseLandingAssistCtrl::set_radius_range(double min, double max)
@@ -101,6 +397,10 @@ void PreciseLandingAssistCtrl::set_radius(double d)
     }
 
     _radius = d;
+    _rim_clusters_stale = true;
+
+    calc_trail_tolerance();
+    invalidate_static_layer();
 }
 
 double PreciseLandingAssistCtrl::radius() const
@@ -120,17 +420,257 @@ double PreciseLandingAssistCtrl::radius_scale_step() const
     return _radius_scale_step;
 }
 
+/**
+ * @brief PreciseLandingAssistCtrl::invalidate_static_layer
+ * render bg, axis and tgt again on the next paint, call it when their look changes
+ */
+void PreciseLandingAssistCtrl::invalidate_static_layer()
+{
+    _static_dirty = true;
+    RenderScheduler::instance()->request_update(render_widget());
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_msaa_samples
+ * multisampling of the widget and the static layer, without it the shapes are anti-aliased analytically,
+ * the format can not change once the ctrl is initialized
+ * @param n
+ */
+void PreciseLandingAssistCtrl::set_msaa_samples(int n)
+{
+    if (n < 0) return;
+
+    _msaa_samples = n;
+
+    QSurfaceFormat fmt = format();
+    fmt.setSamples(n);
+    setFormat(fmt);
+}
+
+int PreciseLandingAssistCtrl::msaa_samples() const
+{
+    return _msaa_samples;
+}
+
+FrameStats PreciseLandingAssistCtrl::last_frame_stats() const
+{
+    return _last_frame_stats;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::gpu_memory
+ * estimated bytes, rgba8 color and depth24 stencil8 per sample of the widget framebuffer,
+ * a multisampled widget resolves into one more color texture,
+ * plus the static layer, the buffers and the glyph textures
+ */
+qint64 PreciseLandingAssistCtrl::gpu_memory() const
+{
+    const QSize sz = size() * devicePixelRatio();
+    const qint64 pixels = qint64(sz.width()) * sz.height();
+    const int samples = format().samples();
+
+    qint64 bytes = pixels * 8 * qMax(samples, 1);
+    if (samples > 0) bytes += pixels * 4;
+
+    if (_fbo_static)
+    {
+        bytes += qint64(_fbo_static->width()) * _fbo_static->height() * 4;
+    }
+    if (_fbo_static_ms)
+    {
+        bytes += qint64(_fbo_static_ms->width()) * _fbo_static_ms->height() * 4 * _fbo_static_ms->format().samples();
+    }
+
+    bytes += buffer_bytes();
+    bytes += _glyph_atlas.texture_bytes();
+
+    return bytes;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_target
+ * add or update one target of the fleet, call the fleet methods in the gui thread,
+ * the change is drawn after the next `update_ui`
+ * @param id
+ * @param st
+ */
+void PreciseLandingAssistCtrl::set_target(int id, const PreciseLandingState &st)
+{
+    if (st.distance < 0) return;
+
+    // a target beyond the radius is picked by its bin only
+    const bool outside = (st.distance >= _radius);
+    _hash_targets.insert(id, st);
+    _rim_clusters.update(id, st.direction, outside);
+    if (outside) _target_grid.remove(id);
+    _visible_dirty = true;
+}
+
+void PreciseLandingAssistCtrl::remove_target(int id)
+{
+    _hash_targets.remove(id);
+    _set_labelled_targets.remove(id);
+    _target_grid.remove(id);
+    _rim_clusters.remove(id);
+    if (id == _hovered_target) _hovered_target = -1;
+    _visible_dirty = true;
+}
+
+void PreciseLandingAssistCtrl::clear_targets()
+{
+    _hash_targets.clear();
+    _set_labelled_targets.clear();
+    _target_grid.clear();
+    _rim_clusters.clear();
+    _hovered_target = -1;
+    _visible_dirty = true;
+}
+
+QList<int> PreciseLandingAssistCtrl::target_ids() const
+{
+    return _hash_targets.keys();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_target_labelled
+ * only labelled targets get a leader line and a distance label
+ */
+void PreciseLandingAssistCtrl::set_target_labelled(int id, bool labelled)
+{
+    if (labelled)
+    {
+        _set_labelled_targets.insert(id);
+    }
+    else
+    {
+        _set_labelled_targets.remove(id);
+    }
+
+    _visible_dirty = true;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::target_at
+ * the markers of the frame on the screen, the grid is searched around pos only
+ */
+int PreciseLandingAssistCtrl::target_at(const QPoint &pos) const
+{
+    sync_target_grid();
+    return _target_grid.pick(QPointF(pos), target_pick_radius_px);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::set_hovered_target
+ * the label is drawn at once, not after the next `update_ui`
+ */
+void PreciseLandingAssistCtrl::set_hovered_target(int id)
+{
+    if (id == _hovered_target) return;
+
+    _hovered_target = id;
+    _visible_dirty = true;
+
+    rebuild_frame();
+}
+
+int PreciseLandingAssistCtrl::hovered_target() const
+{
+    return _hovered_target;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::rim_bin_at
+ * the bin whose chevron is nearest to pos within the pick radius, -1 if none,
+ * a frame has a chevron per occupied bin only, they are searched one by one
+ */
+int PreciseLandingAssistCtrl::rim_bin_at(const QPoint &pos) const
+{
+    int bin = -1;
+    double minDist2 = target_pick_radius_px * target_pick_radius_px;
+
+    for (int i = 0; i < _frame.rim_pixels.size(); ++i)
+    {
+        const QPointF d = _frame.rim_pixels.at(i) - QPointF(pos);
+        const double dist2 = d.x()*d.x() + d.y()*d.y();
+        if (dist2 > minDist2) continue;
+
+        minDist2 = dist2;
+        bin = _frame.rim_bins.at(i);
+    }
+
+    return bin;
+}
+
+void PreciseLandingAssistCtrl::set_rim_bin_labelled(int bin, bool labelled)
+{
+    if (labelled)
+    {
+        _set_labelled_rim_bins.insert(bin);
+    }
+    else
+    {
+        _set_labelled_rim_bins.remove(bin);
+    }
+
+    _visible_dirty = true;
+}
+
+void PreciseLandingAssistCtrl::set_hovered_rim_bin(int bin)
+{
+    if (bin == _hovered_rim_bin) return;
+
+    _hovered_rim_bin = bin;
+    _visible_dirty = true;
+
+    rebuild_frame();
+}
+
+int PreciseLandingAssistCtrl::hovered_rim_bin() const
+{
+    return _hovered_rim_bin;
+}
+
 void PreciseLandingAssistCtrl::init_members()
 {
     _direction      = 0;
     _distance       = 0;
     _uav_angle      = 0;
 
+    _state.store(PreciseLandingState(_distance, _direction, _uav_angle));
+    _update_pending = false;
+
+    _dead_reckoning_enabled = true;
+    _state_version = 0;
+
+    _trail_enabled = true;
+    _trail_uploaded = 0;
+
     _min_radius     = 50;
     _max_radius     = 2000;
     _radius         = 500;
     _radius_scale_step  = 25;
 
+    _fbo_static     = nullptr;
+    _fbo_static_ms  = nullptr;
+    _static_dirty   = true;
+    _msaa_samples   = default_msaa_samples;
+    _backend        = OpenGLBackend;
+    _gl_resolved    = false;
+    _profiler_overlay   = false;
+    _frame_elision  = true;
+    _host           = nullptr;
+    _elided_frames  = 0;
+    _update_filter  = true;
+    _visible_dirty  = true;
+    _suppressed_updates = 0;
+    _target_grid_synced = false;
+    _target_grid_radius = 0;
+    _rim_clusters_stale = true;
+    _geometry_worker    = false;
+    _frame_pending      = false;
+    _hovered_target = -1;
+    _hovered_rim_bin = -1;
+
     {
         const float f = 0.8f;
         _vec_axis_pts.push_back(GLPoint2f(-1*f, 0));
@@ -153,6 +693,10 @@ void PreciseLandingAssistCtrl::init_members()
         _vec_uav_outside_triangle_pts.push_back(GLPoint2f(0, 0));
     }
 
+    // the gl shapes are set in `initializeGL`
+    _raster_backend.set_marker_shape(0, _vec_uav_triangle_pts);
+    _raster_backend.set_marker_shape(1, _vec_uav_outside_triangle_pts);
+
     // colors
     {
         _cl_gray = qcolor_2_gl_color3f(QColor(79, 91, 104));
@@ -173,22 +717,27 @@ void PreciseLandingAssistCtrl::init_ui()
     f.setFamily("Microsoft YaHei");
     setFont(f);
 
+    // hover picking, a move with a button pressed still drags the parent
+    setMouseTracking(true);
+
     // pay attention to the position of initialization
     QSurfaceFormat fmt = format();
-    fmt.setSamples(18);
+    fmt.setSamples(_msaa_samples);
     setFormat(fmt);
 }
 
 void PreciseLandingAssistCtrl::init_signal_slots()
 {
-
+    // keep predicting at the display rate until the prediction settles
+    RenderScheduler::instance()->register_widget(this, [this]()
+    {
+        tick_prediction();
+    });
 }
 
 void PreciseLandingAssistCtrl::test()
 {
-    QTimer *tm = new QTimer();
-    tm->setInterval(1000 / 10);
-    connect(tm, &QTimer::timeout, [=]()
+    RenderScheduler::instance()->register_widget(this, [=]()
     {
         static double dis = 600;
         static double direct = 60;
@@ -203,93 +752,333 @@ void PreciseLandingAssistCtrl::test()
         set_uav_angle(angle * PI / 180);
 
         update_ui();
-    });
-    tm->start();
+    }, 1000 / 10);
 }
 
+/**
+ * @brief PreciseLandingAssistCtrl::calc_members
+ * the frame of the members is built here, or on the worker pool with `geometry_worker` and taken by `take_frame`
+ */
 void PreciseLandingAssistCtrl::calc_members()
 {
-    calc_uav_pos();
-    calc_distance_mark_points();
-    calc_distance_mark_text();
+    // nothing is calculated before the first `update_ui`
+    if (_state_version == 0) return;
+
+    if (_rim_clusters_stale) calc_rim_clusters();
+
+    const PreciseLandingState st(_distance, _direction, _uav_angle);
+    if (_geometry_worker)
+    {
+        _frame_pipeline.submit(FrameInput(st, _radius, _viewport_transform, _hash_targets, _set_labelled_targets,
+                                          _hovered_target, _rim_clusters, _set_labelled_rim_bins, _hovered_rim_bin));
+        return;
+    }
+
+    _frame.build(st, _radius, _viewport_transform, _hash_targets, _set_labelled_targets, _hovered_target, _rim_clusters,
+                 _set_labelled_rim_bins, _hovered_rim_bin);
+    _target_grid_synced = false;
 }
 
-void PreciseLandingAssistCtrl::calc_uav_pos()
+/**
+ * @brief PreciseLandingAssistCtrl::calc_rim_clusters
+ * the targets beyond the radius binned again for the current radius and size,
+ * a bin no longer holds the targets it was labelled for
+ */
+void PreciseLandingAssistCtrl::calc_rim_clusters()
 {
-    _uav_is_inside = (_distance < _radius);
+    _set_labelled_rim_bins.clear();
+    _hovered_rim_bin = -1;
 
-    float ratio = static_cast<float>(_distance / _radius);
-    float r = circle_f * (ratio < 1 ? ratio : 1);
-    float x = r * static_cast<float>(cos(_direction + PI/2));
-    float y = r * static_cast<float>(sin(_direction + PI/2));
-    _uav_pos = GLPoint2f(x, y);
+    _rim_clusters.clear();
+    _rim_clusters.set_bin_count(FramePacket::rim_bin_count(_viewport_transform.viewport()));
+    for (auto it = _hash_targets.constBegin(); it != _hash_targets.constEnd(); ++it)
+    {
+        _rim_clusters.update(it.key(), it.value().direction, it.value().distance >= _radius);
+    }
+
+    _rim_clusters_stale = false;
 }
 
-void PreciseLandingAssistCtrl::calc_distance_mark_points()
+/**
+ * @brief PreciseLandingAssistCtrl::sync_target_grid
+ * the markers of `_frame` into the grid, targets removed since it was built are left out,
+ * a new size or radius moves every marker, the grid is filled again in one pass
+ */
+void PreciseLandingAssistCtrl::sync_target_grid() const
 {
-    static const float h_line_w = 0.4f;
-    float hLineXOffset = h_line_w * (_uav_pos.x < 0 ? -1 : 1);
-    GLPoint2f ptUav = (_uav_is_inside ? _uav_pos : scale_gl_pos(_uav_pos, 1.2f));
-    GLPoint2f ptEnd = GLPoint2f(ptUav.x + hLineXOffset, ptUav.y);
+    if (_target_grid_synced) return;
 
-    // line points
+    const QRectF rc(_frame.transform.viewport());
+    const bool refill = (rc != _target_grid.bounds() || _frame.radius != _target_grid_radius);
+    if (refill)
     {
-        _vec_distance_lines_pts.clear();
-        _vec_distance_lines_pts.push_back(pt_center);
-        _vec_distance_lines_pts.push_back(ptUav);
-        _vec_distance_lines_pts.push_back(ptEnd);
+        _target_grid.clear();
+        _target_grid.begin_bulk();
+        _target_grid.set_bounds(rc, target_grid_cell_px);
+        _target_grid_radius = _frame.radius;
     }
 
-    // txt points
+    for (int i = 0; i < _frame.target_ids.size(); ++i)
     {
-        static const float txt_h = 0.1f;
-        GLPoint2f pt1, pt2;
+        const int id = _frame.target_ids.at(i);
+        if (!_hash_targets.contains(id)) continue;
 
-        if (_uav_pos.x < 0)
-        {
-            pt1 = GLPoint2f(ptEnd.x, ptEnd.y + txt_h);
-            pt2 = GLPoint2f(ptUav);
-        }
-        else
-        {
-            pt1 = GLPoint2f(ptUav.x, ptUav.y + txt_h);
-            pt2 = GLPoint2f(ptEnd);
-        }
+        _target_grid.update(id, _frame.target_pixels.at(i));
+    }
+
+    if (refill) _target_grid.end_bulk();
+    _target_grid_synced = true;
+}
 
-        _vec_distance_txt_pts.clear();
-        _vec_distance_txt_pts.push_back(pt1);
-        _vec_distance_txt_pts.push_back(pt2);
+/**
+ * @brief PreciseLandingAssistCtrl::show_frame
+ * repaint with `_frame`, unless it draws the same as the last frame shown
+ */
+void PreciseLandingAssistCtrl::show_frame()
+{
+    if (_frame_elision && is_frame_unchanged())
+    {
+        ++_elided_frames;
+        return;
     }
+
+    RenderScheduler::instance()->request_update(render_widget());
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::take_frame
+ * the newest packet of the worker pool becomes `_frame`
+ */
+void PreciseLandingAssistCtrl::take_frame()
+{
+    // switched off meanwhile, the frame built here is newer, the packet is recycled with the next one
+    if (!_geometry_worker) return;
+    if (!_frame_pipeline.take(_frame)) return;
+
+    _target_grid_synced = false;
+    show_frame();
 }
 
-void PreciseLandingAssistCtrl::calc_distance_mark_text()
+/**
+ * @brief PreciseLandingAssistCtrl::frame_ready
+ * called on a worker, the gui thread is asked for at most one pending `take_frame`
+ */
+void PreciseLandingAssistCtrl::frame_ready()
 {
-    if (_uav_is_inside)
+    if (_frame_pending.exchange(true)) return;
+
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        _frame_pending = false;
+        take_frame();
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::rebuild_frame
+ * the same state with a new hover or new labels, always repainted
+ */
+void PreciseLandingAssistCtrl::rebuild_frame()
+{
+    calc_members();
+    if (!_geometry_worker) RenderScheduler::instance()->request_update(render_widget());
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::is_frame_unchanged
+ * record the dynamic draws of the frame and compare them with the frame of the last `update_ui`,
+ * the static layer and the trail are compared by their keys, a dirty static layer or the overlay always repaints
+ */
+bool PreciseLandingAssistCtrl::is_frame_unchanged()
+{
+    _record_backend.begin_frame(width(), height(), _cl_dark_blue);
+
+    draw_distance_mark(_record_backend);
+    draw_targets(_record_backend);
+    draw_uav(_record_backend);
+
+    _record_backend.record_key(_backend);
+    _record_backend.record_key(qRound64(_frame.radius * 1000));
+
+    if (_trail_enabled && !_trail.is_empty())
     {
-        _str_distance = QString("%1m").arg(_distance, 0, 'f', 2);
+        const double fadeStep = _trail.duration() / trail_fade_steps;
+        _record_backend.record_key(_trail.end_seq());
+        _record_backend.record_key(static_cast<qint64>((monotonic_time() - _trail.start_time()) / fadeStep));
     }
-    else
+
+    _record_backend.end_frame();
+
+    const bool same = _record_backend.swap_and_compare();
+    return (same && !_static_dirty && !_profiler_overlay);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::calc_visible_state
+ * quantise `st` to the device pixels of the current size and radius, without touching the members
+ */
+VisibleState PreciseLandingAssistCtrl::calc_visible_state(const PreciseLandingState &st, double t) const
+{
+    VisibleState vis;
+
+    const double dpr = devicePixelRatioF();
+    vis.w_px = qRound(width() * dpr);
+    vis.h_px = qRound(height() * dpr);
+    vis.radius_mm = qRound64(_radius * 1000);
+    vis.backend = _backend;
+
+    bool inside = false;
+    const auto pos = FramePacket::target_pos(_radius, st.distance, st.direction, inside);
+    vis.x_px = qRound(pos.x * vis.w_px / 2);
+    vis.y_px = qRound(pos.y * vis.h_px / 2);
+
+    // the farthest vertex of the triangle moves a pixel a step
+    const auto &vecPts = (inside ? _vec_uav_triangle_pts : _vec_uav_outside_triangle_pts);
+    float tip = 0;
+    for (const auto &pt : vecPts)
+    {
+        tip = qMax(tip, static_cast<float>(sqrt(pt.x*pt.x + pt.y*pt.y)));
+    }
+
+    const double tipPx = tip * qMax(vis.w_px, vis.h_px) / 2.0;
+    const double angle = (inside ? st.uav_angle : st.direction);
+    vis.angle_step = (tipPx > 0 ? qRound64(angle * tipPx) : 0);
+
+    // the two decimals of `FramePacket::distance_text`
+    vis.distance_cm = (inside ? qRound64(st.distance * 100) : -1);
+
+    if (_trail_enabled && !_trail.is_empty())
+    {
+        const double fadeStep = _trail.duration() / trail_fade_steps;
+        vis.trail_end_seq = _trail.end_seq();
+        vis.trail_fade_step = static_cast<qint64>((t - _trail.start_time()) / fadeStep);
+    }
+
+    return vis;
+}
+
+void PreciseLandingAssistCtrl::add_trail_sample(double t, const PreciseLandingState &st)
+{
+    const double x = -st.distance * sin(st.direction);
+    const double y = st.distance * cos(st.direction);
+
+    // a hovering uav adds nothing to the trail, with the filter neither does noise below the simplify tolerance
+    if (!_trail.is_empty())
     {
-        _str_distance = QString(">%1m").arg(_radius);
+        const auto &last = _trail.sample(_trail.end_seq() - 1);
+        const double dx = static_cast<float>(x) - last.x;
+        const double dy = static_cast<float>(y) - last.y;
+        const double tol = (_update_filter ? _trail.tolerance() : 0);
+        if (dx*dx + dy*dy <= tol*tol) return;
     }
+
+    _trail.add_sample(t, x, y);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::calc_trail_tolerance
+ * meter per pixel of the current radius and size, the trail is simplified again when it changes
+ */
+void PreciseLandingAssistCtrl::calc_trail_tolerance()
+{
+    const double px = qMax(width(), height()) * devicePixelRatioF() / 2 * circle_f;
+    if (px <= 0) return;
+
+    _trail.set_tolerance(trail_tolerance_px * _radius / px);
 }
 
 void PreciseLandingAssistCtrl::wheelEvent(QWheelEvent *e)
 {
-    auto diff = _radius_scale_step * (e->delta() > 0 ? 1 : -1);
-    auto r = _radius + diff;
-    set_radius(r);
+    zoom(e->delta() > 0 ? 1 : -1);
 
     qDebug() << "radius:" << min_radius() << max_radius() << radius();
 }
 
+void PreciseLandingAssistCtrl::changeEvent(QEvent *e)
+{
+    if (e->type() == QEvent::FontChange) _vec_text_fonts.clear();
+
+    QOpenGLWidget::changeEvent(e);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::mousePressEvent
+ * a click on a marker or a rim chevron toggles its label, elsewhere the press goes on to the parent
+ */
+void PreciseLandingAssistCtrl::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() != Qt::LeftButton)
+    {
+        e->ignore();
+        return;
+    }
+
+    const int id = target_at(e->pos());
+    const int bin = (id < 0 ? rim_bin_at(e->pos()) : -1);
+    if (id >= 0)
+    {
+        set_target_labelled(id, !_set_labelled_targets.contains(id));
+    }
+    else if (bin >= 0)
+    {
+        set_rim_bin_labelled(bin, !_set_labelled_rim_bins.contains(bin));
+    }
+    else
+    {
+        e->ignore();
+        return;
+    }
+
+    rebuild_frame();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::mouseMoveEvent
+ * the mouse is tracked for hovering, a move with a button pressed goes on to the parent
+ */
+void PreciseLandingAssistCtrl::mouseMoveEvent(QMouseEvent *e)
+{
+    if (e->buttons() != Qt::NoButton)
+    {
+        e->ignore();
+        return;
+    }
+
+    const int id = target_at(e->pos());
+    set_hovered_rim_bin(id < 0 ? rim_bin_at(e->pos()) : -1);
+    set_hovered_target(id);
+}
+
+void PreciseLandingAssistCtrl::leaveEvent(QEvent *e)
+{
+    set_hovered_rim_bin(-1);
+    set_hovered_target(-1);
+
+    QOpenGLWidget::leaveEvent(e);
+}
+
 void PreciseLandingAssistCtrl::initializeGL()
 {
-    if (!initializeOpenGLFunctions())
+    _gl_resolved = initializeOpenGLFunctions();
+    if (!_gl_resolved)
     {
-        qDebug() << "init opengl functions failed";
+        qDebug() << "init opengl functions failed, render on the cpu";
+        _backend = RasterBackend;
+        return;
     }
 
+    init_gl_buffers();
+    set_sdf_shapes(format().samples() <= 0);
+    _profiler.set_gl(this);
+
+    set_marker_shape(0, _vec_uav_triangle_pts);
+    set_marker_shape(1, _vec_uav_outside_triangle_pts);
+
+    // a new context starts with an empty ring
+    init_trail_buffer(ApproachTrail::capacity);
+    _trail_uploaded = 0;
+    set_trail_indices(_trail.take_indices());
+
     reset_color();
 }
 
@@ -297,108 +1086,542 @@ void PreciseLandingAssistCtrl::resizeGL(int w, int h)
 {
     QOpenGLWidget::resizeGL(w, h);
 
-    glViewport(0, 0, w, h);
+    if (_gl_resolved) glViewport(0, 0, w, h);
+
+    // tessellate the static geometry again for the new size
+    set_viewport_size(w, h);
+    _viewport_transform.set_viewport(QRect(0, 0, w, h));
+    _rim_clusters_stale = true;
+    calc_members();
+    if (_gl_resolved) invalidate_batches();
+    calc_trail_tolerance();
+
+    _static_dirty = true;
 }
 
 void PreciseLandingAssistCtrl::paintGL()
 {
+    QElapsedTimer tm;
+    tm.start();
+    reset_draw_call_count();
+
     QOpenGLWidget::paintGL();
 
-    // draw graph
-    draw_bg();
-    draw_axis();
-    draw_distance_mark();
-    draw_tgt();
-    draw_uav();
+    if (_backend == RasterBackend || !_gl_resolved)
+    {
+        // the gl only presents the image
+        _profiler.begin_frame(false);
+        draw_raster_scene(size() * devicePixelRatio());
+        _profiler.end_frame();
+
+        if (_profiler_overlay) draw_profiler_overlay(_raster_backend);
+        _raster_backend.end_frame();
+
+        QPainter p(this);
+        p.drawImage(rect(), _raster_backend.image());
+    }
+    else
+    {
+        _profiler.begin_frame();
+        _gl_backend.begin_frame(width(), height(), _cl_dark_blue);
+
+        _profiler.push_stage(FrameProfiler::StageStaticLayer);
+        draw_static_layer();
+        _profiler.pop_stage();
+
+        _profiler.push_stage(FrameProfiler::StageTrail);
+        draw_approach_trail();
+        _profiler.pop_stage();
+
+        draw_stage(FrameProfiler::StageDistanceMark, &PreciseLandingAssistCtrl::draw_distance_mark, _gl_backend);
+        draw_stage(FrameProfiler::StageTargets, &PreciseLandingAssistCtrl::draw_targets, _gl_backend);
+        draw_stage(FrameProfiler::StageUav, &PreciseLandingAssistCtrl::draw_uav, _gl_backend);
+
+        _profiler.end_frame();
+
+        if (_profiler_overlay) draw_profiler_overlay(_gl_backend);
+        _gl_backend.end_frame();
+    }
+
+    _last_frame_stats.cpu_ns = tm.nsecsElapsed();
+    _last_frame_stats.draw_calls = draw_call_count();
+    _last_frame_stats.gpu_bytes = gpu_memory();
+}
+
+void PreciseLandingAssistCtrl::set_backend(Backend b)
+{
+    if (b == _backend) return;
+
+    // before `initializeGL` the functions are not known yet, it falls back by itself if they fail
+    if (b == OpenGLBackend && !_gl_resolved && isValid())
+    {
+        qDebug() << "opengl functions not resolved, keep the cpu backend";
+        return;
+    }
+
+    _backend = b;
+    _static_dirty = true;
+    update();
+}
+
+PreciseLandingAssistCtrl::Backend PreciseLandingAssistCtrl::backend() const
+{
+    return _backend;
+}
+
+void PreciseLandingAssistCtrl::set_profiling(bool b)
+{
+    _profiler.set_enabled(b);
+}
+
+bool PreciseLandingAssistCtrl::profiling() const
+{
+    return _profiler.is_enabled();
+}
+
+const FrameProfiler &PreciseLandingAssistCtrl::profiler() const
+{
+    return _profiler;
+}
+
+void PreciseLandingAssistCtrl::set_profiler_overlay(bool b)
+{
+    if (b == _profiler_overlay) return;
+
+    _profiler_overlay = b;
+    update();
+}
+
+bool PreciseLandingAssistCtrl::profiler_overlay() const
+{
+    return _profiler_overlay;
+}
+
+void PreciseLandingAssistCtrl::set_frame_elision(bool b)
+{
+    _frame_elision = b;
+}
+
+bool PreciseLandingAssistCtrl::frame_elision() const
+{
+    return _frame_elision;
+}
+
+qint64 PreciseLandingAssistCtrl::elided_frames() const
+{
+    return _elided_frames;
+}
+
+void PreciseLandingAssistCtrl::set_update_filter(bool b)
+{
+    _update_filter = b;
+    _visible_dirty = true;
 }
 
-void PreciseLandingAssistCtrl::draw_bg()
+bool PreciseLandingAssistCtrl::update_filter() const
 {
-    gl_clear_color3f(_cl_dark_blue);
+    return _update_filter;
+}
 
-    gl_color3f(_cl_blue);
-    draw_ellipse(pt_top_left, pt_bottom_right);
+qint64 PreciseLandingAssistCtrl::suppressed_updates() const
+{
+    return _suppressed_updates;
+}
 
-    gl_color3f(_cl_gray);
-    draw_ellipse(pt_top_left, pt_bottom_right, GL_LINE_LOOP);
+void PreciseLandingAssistCtrl::set_geometry_worker(bool b)
+{
+    _geometry_worker = b;
+    _visible_dirty = true;
 }
 
-void PreciseLandingAssistCtrl::draw_axis()
+bool PreciseLandingAssistCtrl::geometry_worker() const
+{
+    return _geometry_worker;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::built_frames
+ * packets built by the worker pool, any thread
+ */
+qint64 PreciseLandingAssistCtrl::built_frames() const
+{
+    return _frame_pipeline.built_count();
+}
+
+const FramePacket &PreciseLandingAssistCtrl::frame() const
+{
+    return _frame;
+}
+
+const QVector<GLPoint2f> &PreciseLandingAssistCtrl::uav_shape(bool inside) const
+{
+    return (inside ? _vec_uav_triangle_pts : _vec_uav_outside_triangle_pts);
+}
+
+QImage PreciseLandingAssistCtrl::render_image(const QSize &sz)
+{
+    draw_raster_scene(sz);
+    _raster_backend.end_frame();
+
+    return _raster_backend.image();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::draw_raster_scene
+ * the same scene as the gl path, nothing is cached between frames, the frame is left open
+ */
+void PreciseLandingAssistCtrl::draw_raster_scene(const QSize &sz)
+{
+    _raster_backend.begin_frame(sz.width(), sz.height(), _cl_dark_blue);
+
+    draw_stage(FrameProfiler::StageBg, &PreciseLandingAssistCtrl::draw_bg, _raster_backend);
+    draw_stage(FrameProfiler::StageAxis, &PreciseLandingAssistCtrl::draw_axis, _raster_backend);
+    draw_stage(FrameProfiler::StageTgt, &PreciseLandingAssistCtrl::draw_tgt, _raster_backend);
+    draw_static_labels(_raster_backend);
+    draw_stage(FrameProfiler::StageTrail, &PreciseLandingAssistCtrl::draw_trail_lines, _raster_backend);
+    draw_stage(FrameProfiler::StageDistanceMark, &PreciseLandingAssistCtrl::draw_distance_mark, _raster_backend);
+    draw_stage(FrameProfiler::StageTargets, &PreciseLandingAssistCtrl::draw_targets, _raster_backend);
+    draw_stage(FrameProfiler::StageUav, &PreciseLandingAssistCtrl::draw_uav, _raster_backend);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::draw_static_layer
+ * bg, axis and tgt are rendered into a framebuffer once, then composited as one textured quad
+ */
+void PreciseLandingAssistCtrl::draw_static_layer()
+{
+    if (!QOpenGLFramebufferObject::hasOpenGLFramebufferObjects())
+    {
+        draw_static_shapes(*this, _gl_backend, 0);
+        return;
+    }
+
+    if (_static_dirty || !_fbo_static)
+    {
+        render_static_layer();
+    }
+
+    gl_color3f(_cl_white);
+    glBindTexture(GL_TEXTURE_2D, _fbo_static->texture());
+    draw_img(GLPoint2f(-1, 1), GLPoint2f(1, -1));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PreciseLandingAssistCtrl::render_static_layer()
+{
+    const QSize sz = size() * devicePixelRatio();
+    const int samples = format().samples();
+
+    if (!_fbo_static || _fbo_static->size() != sz)
+    {
+        release_static_layer();
+
+        _fbo_static = new QOpenGLFramebufferObject(sz);
+
+        // render with the samples of the widget, then resolve into the texture
+        if (samples > 0)
+        {
+            QOpenGLFramebufferObjectFormat fmt;
+            fmt.setSamples(samples);
+            _fbo_static_ms = new QOpenGLFramebufferObject(sz, fmt);
+        }
+    }
+
+    auto fbo = (_fbo_static_ms ? _fbo_static_ms : _fbo_static);
+    fbo->bind();
+    glViewport(0, 0, sz.width(), sz.height());
+    {
+        clear_color_buffer(_cl_dark_blue);
+        draw_static_shapes(*this, _gl_backend, 0);
+    }
+
+    if (_fbo_static_ms)
+    {
+        QOpenGLFramebufferObject::blitFramebuffer(_fbo_static, _fbo_static_ms);
+    }
+
+    // back to the framebuffer of the widget
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glViewport(0, 0, width(), height());
+
+    _static_dirty = false;
+}
+
+void PreciseLandingAssistCtrl::release_static_layer()
+{
+    delete _fbo_static_ms;
+    delete _fbo_static;
+
+    _fbo_static_ms = nullptr;
+    _fbo_static = nullptr;
+    _static_dirty = true;
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::draw_static_shapes
+ * bg, axis and tgt through a gl backend, each recorded into a batch of `gl` once
+ * @param gl: the ctrl itself, or the host drawing it
+ * @param batchBase: first batch id, every size the shapes are tessellated for needs its own
+ */
+void PreciseLandingAssistCtrl::draw_static_shapes(GLFuncUtils &gl, RenderBackend &be, int batchBase)
+{
+    _profiler.push_stage(FrameProfiler::StageBg);
+    draw_batched(gl, be, batchBase + batch_bg, &PreciseLandingAssistCtrl::draw_bg);
+    _profiler.pop_stage();
+
+    _profiler.push_stage(FrameProfiler::StageAxis);
+    draw_batched(gl, be, batchBase + batch_axis, &PreciseLandingAssistCtrl::draw_axis);
+    _profiler.pop_stage();
+
+    _profiler.push_stage(FrameProfiler::StageTgt);
+    draw_batched(gl, be, batchBase + batch_tgt, &PreciseLandingAssistCtrl::draw_tgt);
+    _profiler.pop_stage();
+
+    draw_static_labels(be);
+}
+
+void PreciseLandingAssistCtrl::draw_batched(GLFuncUtils &gl, RenderBackend &be, int id,
+                                            void (PreciseLandingAssistCtrl::*func)(RenderBackend &))
+{
+    if (gl.draw_batch(id)) return;
+
+    gl.begin_batch(id);
+    {
+        (this->*func)(be);
+    }
+    gl.end_batch();
+
+    gl.draw_batch(id);
+}
+
+void PreciseLandingAssistCtrl::draw_stage(FrameProfiler::Stage s, void (PreciseLandingAssistCtrl::*func)(RenderBackend &),
+                                          RenderBackend &be)
+{
+    _profiler.push_stage(s);
+    (this->*func)(be);
+    _profiler.pop_stage();
+}
+
+void PreciseLandingAssistCtrl::draw_bg(RenderBackend &be)
+{
+    be.set_color(_cl_blue);
+    be.draw_disc(pt_center, circle_f, circle_f);
+
+    be.set_color(_cl_gray);
+    be.draw_ring(pt_center, circle_f, circle_f);
+}
+
+void PreciseLandingAssistCtrl::draw_axis(RenderBackend &be)
+{
+    be.set_color(_cl_gray);
+    be.draw_lines(_vec_axis_pts, GL_LINES);
+}
+
+void PreciseLandingAssistCtrl::draw_tgt(RenderBackend &be)
+{
+    be.set_color(_cl_red);
+    be.draw_disc(pt_center, tgt_radius, tgt_radius);
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::draw_static_labels
+ * text is never recorded into a batch
+ */
+void PreciseLandingAssistCtrl::draw_static_labels(RenderBackend &be)
 {
     static const QString str_n = "N";
+    static const QString str_h = "H";
     static const float axis_radius = 0.8f;
     static const float txt_w = 0.1f;
     static const float txt_h = 0.2f;
-    static const GLPoint2f pt_me_top_left = GLPoint2f(0, axis_radius);
-    static const GLPoint2f pt_me_bottom_right = GLPoint2f(txt_w, axis_radius-txt_h);
+    static const GLPoint2f pt_n_top_left = GLPoint2f(0, axis_radius);
+    static const GLPoint2f pt_n_bottom_right = GLPoint2f(txt_w, axis_radius-txt_h);
+    static const GLPoint2f pt_h_top_left = GLPoint2f(-tgt_radius, tgt_radius);
+    static const GLPoint2f pt_h_bottom_right = GLPoint2f(tgt_radius, -tgt_radius);
 
-    gl_color3f(_cl_gray);
-    draw_lines(_vec_axis_pts, GL_LINES);
-
-    draw_text(str_n, pt_me_top_left, pt_me_bottom_right);
+    draw_text(be, str_n, pt_n_top_left, pt_n_bottom_right);
+    draw_text(be, str_h, pt_h_top_left, pt_h_bottom_right);
 }
 
-void PreciseLandingAssistCtrl::draw_tgt()
+/**
+ * @brief PreciseLandingAssistCtrl::draw_approach_trail
+ * append the samples added since the last frame to the ring, the trail is scaled to `_radius` on the gpu
+ */
+void PreciseLandingAssistCtrl::draw_approach_trail()
 {
-    static const float radius = 0.03f;
-    static const QString str_h = "H";
-    static const GLPoint2f pt_me_top_left = GLPoint2f(-radius, radius);
-    static const GLPoint2f pt_me_bottom_right = GLPoint2f(radius, -radius);
+    if (!_trail_enabled || _trail.is_empty()) return;
+
+    const qint64 first = qMax(_trail_uploaded, _trail.begin_seq());
+    const qint64 end = _trail.end_seq();
+    if (first < end)
+    {
+        _vec_trail_upload.resize(static_cast<int>(end - first));
+        for (qint64 seq = first; seq < end; ++seq)
+        {
+            const auto &s = _trail.sample(seq);
+            _vec_trail_upload[static_cast<int>(seq - first)] = GLPoint3f(s.x, s.y, s.t);
+        }
+
+        write_trail_vertices(_trail.slot(first), _vec_trail_upload.constData(), _vec_trail_upload.size());
+        _trail_uploaded = end;
+    }
+
+    if (_trail.indices_changed())
+    {
+        set_trail_indices(_trail.take_indices());
+    }
 
-    gl_color3f(_cl_red);
-    draw_ellipse(pt_center, radius, radius);
-    draw_text(str_h, pt_me_top_left, pt_me_bottom_right);
+    const auto now = static_cast<float>(monotonic_time() - _trail.start_time());
+    gl_color4f(GLColor4f(_cl_yellow.r, _cl_yellow.g, _cl_yellow.b, trail_alpha));
+    draw_trail(static_cast<float>(circle_f / _radius), circle_f, now, static_cast<float>(_trail.duration()),
+               _trail.tail_slot(), _trail.tail_count());
 }
 
-void PreciseLandingAssistCtrl::draw_uav()
+/**
+ * @brief PreciseLandingAssistCtrl::draw_trail_lines
+ * the trail as plain lines for the backends without the gpu ring, not faded,
+ * the samples outside the circle or older than the duration are left out
+ */
+void PreciseLandingAssistCtrl::draw_trail_lines(RenderBackend &be)
 {
+    if (!_trail_enabled || _trail.is_empty()) return;
 
-    glPushMatrix();
-    gl_color3f(_cl_yellow);
-    glTranslatef(_uav_pos.x, _uav_pos.y, 0);
+    const float scale = static_cast<float>(circle_f / _radius);
+    const float minTime = static_cast<float>(monotonic_time() - _trail.start_time() - _trail.duration());
 
-    if (_uav_is_inside)
+    _vec_trail_lines_pts.clear();
+    bool hasLast = false;
+    GLPoint2f ptLast;
+
+    auto addSample = [&](const TrailSample &s)
     {
-        const float angle = static_cast<float>(_uav_angle * 180 / PI);
-        glRotatef(angle, 0, 0, 1);
-        draw_triangle(_vec_uav_triangle_pts);
+        const GLPoint2f pt(s.x * scale, s.y * scale);
+        const bool visible = (s.t >= minTime && pt.x*pt.x + pt.y*pt.y <= circle_f*circle_f);
+
+        if (visible && hasLast)
+        {
+            _vec_trail_lines_pts << ptLast << pt;
+        }
+
+        hasLast = visible;
+        ptLast = pt;
+    };
+
+    for (auto slot : _trail.indices())
+    {
+        addSample(_trail.sample(slot));
     }
-    else
+
+    const int tailSlot = _trail.tail_slot();
+    for (int i = 0; i < _trail.tail_count(); ++i)
     {
-        const float angle = static_cast<float>(_direction * 180 / PI);
-        glRotatef(angle, 0, 0, 1);
-        draw_triangle(_vec_uav_outside_triangle_pts);
+        addSample(_trail.sample(tailSlot + i));
     }
 
-    glPopMatrix();
+    be.set_color(GLColor4f(_cl_yellow.r, _cl_yellow.g, _cl_yellow.b, trail_alpha));
+    be.draw_lines(_vec_trail_lines_pts, GL_LINES);
 }
 
-void PreciseLandingAssistCtrl::draw_distance_mark()
+void PreciseLandingAssistCtrl::draw_uav(RenderBackend &be)
 {
-    gl_color3f(_cl_gray);
-    draw_lines(_vec_distance_lines_pts, GL_LINE_STRIP);
+    be.set_color(_cl_yellow);
 
-    if (_vec_distance_txt_pts.size() == 2)
+    if (_frame.uav_inside)
     {
-        draw_text(_str_distance, _vec_distance_txt_pts.at(0), _vec_distance_txt_pts.at(1));
+        be.draw_triangle(_vec_uav_triangle_pts, _frame.uav_pos, static_cast<float>(_frame.state.uav_angle));
+    }
+    else
+    {
+        be.draw_triangle(_vec_uav_outside_triangle_pts, _frame.uav_pos, static_cast<float>(_frame.state.direction));
     }
 }
 
-void PreciseLandingAssistCtrl::draw_text(const QString &txt, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight, bool bold,
-                                         int pixelSz, const QColor &cl, int flags)
+void PreciseLandingAssistCtrl::draw_targets(RenderBackend &be)
 {
-    QPainter p(this);
+    if (_frame.target_instances.isEmpty()) return;
+
+    be.set_color(_cl_gray);
+    be.draw_lines(_frame.target_lines_pts, GL_LINES);
+
+    for (const auto &label : _frame.target_labels)
     {
-        auto f = font();
-        f.setBold(bold);
-        f.setPixelSize(pixelSz);
+        draw_text(be, label.text, label.top_left, label.bottom_right);
+    }
 
-        p.setRenderHint(QPainter::Antialiasing);
-        p.setPen(cl);
-        p.setFont(f);
+    be.set_color(_cl_yellow);
+    be.draw_markers(_frame.target_instances);
+
+    for (const auto &badge : _frame.rim_badges)
+    {
+        draw_text(be, badge.text, badge.top_left, badge.bottom_right, true, rim_badge_font_px);
     }
+}
+
+void PreciseLandingAssistCtrl::draw_distance_mark(RenderBackend &be)
+{
+    // nothing is calculated before the first `update_ui`
+    if (_frame.str_distance.isEmpty()) return;
+
+    be.set_color(_cl_gray);
+    be.draw_lines(_frame.distance_lines_pts, GL_LINE_STRIP);
 
-    GLFuncUtils::draw_text(p, rect(), ptTopLeft, ptBottomRight, flags, txt);
+    draw_text(be, _frame.str_distance, _frame.distance_txt_pts.at(0), _frame.distance_txt_pts.at(1));
 }
 
+void PreciseLandingAssistCtrl::draw_text(RenderBackend &be, const QString &txt, const GLPoint2f &ptTopLeft,
+                                         const GLPoint2f &ptBottomRight, bool bold, int pixelSz, const QColor &cl, int flags)
+{
+    _profiler.push_stage(FrameProfiler::StageText);
+    be.set_color(qcolor_2_gl_color4f(cl));
+    be.draw_text(txt, text_font(bold, pixelSz), ptTopLeft, ptBottomRight, flags);
+    _profiler.pop_stage();
+}
 
+/**
+ * @brief PreciseLandingAssistCtrl::text_font
+ * the widget font in one weight and size, built once, a copy of it does not detach
+ */
+const QFont &PreciseLandingAssistCtrl::text_font(bool bold, int pixelSz)
+{
+    for (const auto &f : _vec_text_fonts)
+    {
+        if (f.bold() == bold && f.pixelSize() == pixelSz) return f;
+    }
+
+    auto f = font();
+    f.setBold(bold);
+    f.setPixelSize(pixelSz);
+    _vec_text_fonts.push_back(f);
+
+    return _vec_text_fonts.last();
+}
+
+/**
+ * @brief PreciseLandingAssistCtrl::draw_profiler_overlay
+ * p50 and p99 of every stage at the top left, microsecond, drawn after the profiled frame is closed
+ */
+void PreciseLandingAssistCtrl::draw_profiler_overlay(RenderBackend &be)
+{
+    static const int line_px = 12;
+    static const int margin_px = 4;
+
+    if (!_profiler.is_enabled() || height() <= 0) return;
+
+    const float lineH = 2.0f * line_px / height();
+    const float left = -1 + 2.0f * margin_px / width();
+    float top = 1 - 2.0f * margin_px / height();
+
+    for (int i = 0; i < FrameProfiler::StageCount; ++i)
+    {
+        const QString txt = QString("%1  cpu %2 / %3  gpu %4 / %5")
+                .arg(FrameProfiler::stage_name(i), -8)
+                .arg(_profiler.cpu_percentile(i, 0.5), 0, 'f', 1)
+                .arg(_profiler.cpu_percentile(i, 0.99), 0, 'f', 1)
+                .arg(_profiler.gpu_percentile(i, 0.5), 0, 'f', 1)
+                .arg(_profiler.gpu_percentile(i, 0.99), 0, 'f', 1);
+
+        draw_text(be, txt, GLPoint2f(left, top), GLPoint2f(1, top - lineH), false, line_px - 2, Qt::white,
+                  Qt::AlignLeft | Qt::AlignVCenter);
+        top -= lineH;
+    }
+}
@@ -2,13 +2,87 @@
 #define PreciseLandingAssistCtrl_H
 
 #include <QOpenGLWidget>
-#include <QMutex>
+#include <QOpenGLFramebufferObject>
+#include <QSet>
+
+#include <atomic>
 
 #include "gl_utils.h"
+#include "seq_lock.h"
+#include "precise_landing_state.h"
+#include "dead_reckoning.h"
+#include "approach_trail.h"
+#include "render_scheduler.h"
+#include "gl_render_backend.h"
+#include "raster_render_backend.h"
+#include "frame_profiler.h"
+#include "record_render_backend.h"
+#include "viewport_transform.h"
+#include "target_grid.h"
+#include "rim_clusters.h"
+#include "frame_packet.h"
+#include "frame_pipeline.h"
+
 
+/**
+ * @brief The FrameStats struct
+ * cpu_ns: cpu time of `paintGL`, the gpu work is not waited for
+ * draw_calls: draw calls issued through GLFuncUtils
+ * gpu_bytes: estimated gpu memory of the ctrl, see `gpu_memory`
+ */
+struct FrameStats
+{
+    qint64      cpu_ns;
+    int         draw_calls;
+    qint64      gpu_bytes;
+
+    FrameStats()
+        : cpu_ns(0), draw_calls(0), gpu_bytes(0)
+    {}
+};
+
+/**
+ * @brief The VisibleState struct
+ * a state quantised to what the screen can show, two states with equal members are drawn the same,
+ * x_px, y_px: device pixel of the uav
+ * angle_step: heading in steps of one pixel at the tip of the triangle
+ * distance_cm: the distance text, -1 outside the circle where only the radius is shown
+ */
+struct VisibleState
+{
+    int         x_px;
+    int         y_px;
+    qint64      angle_step;
+    qint64      distance_cm;
+    int         w_px;
+    int         h_px;
+    qint64      radius_mm;
+    int         backend;
+    qint64      trail_end_seq;
+    qint64      trail_fade_step;
+
+    VisibleState()
+        : x_px(0), y_px(0), angle_step(0), distance_cm(0), w_px(0), h_px(0), radius_mm(0), backend(0),
+          trail_end_seq(0), trail_fade_step(0)
+    {}
+
+    bool operator==(const VisibleState &o) const
+    {
+        return (x_px == o.x_px && y_px == o.y_px && angle_step == o.angle_step && distance_cm == o.distance_cm
+                && w_px == o.w_px && h_px == o.h_px && radius_mm == o.radius_mm && backend == o.backend
+                && trail_end_seq == o.trail_end_seq && trail_fade_step == o.trail_fade_step);
+    }
+};
 
 class PreciseLandingAssistCtrl : public QOpenGLWidget, public GLFuncUtils
 {
+public:
+    enum Backend
+    {
+        OpenGLBackend,
+        RasterBackend   // on the cpu, for consoles without a usable gpu
+    };
+
 public:
     PreciseLandingAssistCtrl(QWidget *parent = nullptr);
     ~PreciseLandingAssistCtrl() override;
@@ -23,6 +97,29 @@ public:
     double uav_angle() const;
 
     void update_ui();
+    void tick_prediction();
+
+    void publish_state(const PreciseLandingState &st);
+    PreciseLandingState state() const;
+
+    // dead reckoning between telemetry samples
+    void set_dead_reckoning(bool b);
+    bool dead_reckoning() const;
+
+    void set_prediction_horizon(int ms);
+    int prediction_horizon() const;
+
+    void set_snap_back(int ms);
+    int snap_back() const;
+
+    // approach trail of the uav
+    void set_trail(bool b);
+    bool trail() const;
+
+    void set_trail_duration(int s);
+    int trail_duration() const;
+
+    void clear_trail();
 
 public:
     void set_radius_range(double min, double max);
@@ -35,6 +132,92 @@ public:
     void set_radius_scale_step(double d);
     double radius_scale_step() const;
 
+    void invalidate_static_layer();
+
+    // 0 draws the shapes anti-aliased in the shader, call it before the ctrl is shown
+    void set_msaa_samples(int n);
+    int msaa_samples() const;
+
+    FrameStats last_frame_stats() const;
+    qint64 gpu_memory() const;
+
+    // falls back to RasterBackend by itself if the gl functions can not be resolved,
+    // OpenGLBackend is refused from then on
+    void set_backend(Backend b);
+    Backend backend() const;
+
+    // the current frame drawn by the raster backend, in device pixels
+    QImage render_image(const QSize &sz);
+
+    // cpu and gpu time of every draw stage, off by default
+    void set_profiling(bool b);
+    bool profiling() const;
+    const FrameProfiler &profiler() const;
+
+    void set_profiler_overlay(bool b);
+    bool profiler_overlay() const;
+
+    // drawn by a PreciseLandingAssistHost in one pass with other ctrls, null for its own widget
+    void set_host(QWidget *host);
+    QWidget *host() const;
+
+    // batch ids [batchBase, batchBase + hosted_batch_count) of `gl` are used
+    static const int hosted_batch_count = 3;
+    void render_hosted(GLFuncUtils &gl, RenderBackend &be, const QSize &sz, int batchBase);
+    // drawn by the raster backend for a host without gl functions, in device pixels of the area
+    QImage render_hosted_image(const QSize &sz, qreal dpr);
+
+    // wheel zoom, also forwarded by the widget the hosted ctrl is placed on
+    void zoom(int steps);
+
+    // widget pixels to gl coordinates and back, rebuilt by `resizeGL` or by a new hosted size
+    const ViewportTransform &viewport_transform() const;
+
+    // skip the repaint of `update_ui` if the frame would draw the same as the last one, on by default
+    void set_frame_elision(bool b);
+    bool frame_elision() const;
+    qint64 elided_frames() const;
+
+    // drop the samples of `update_ui` that change nothing visible before anything is calculated, on by default
+    void set_update_filter(bool b);
+    bool update_filter() const;
+    qint64 suppressed_updates() const;
+
+    // build the frame packets on the global thread pool, `paintGL` only draws them, off by default,
+    // the frame of an `update_ui` is shown once its packet arrives
+    void set_geometry_worker(bool b);
+    bool geometry_worker() const;
+    qint64 built_frames() const;
+
+    // the geometry `paintGL` draws, gui thread
+    const FramePacket &frame() const;
+    // the uav triangle in gl units before it is turned and placed, inside the radius or on the rim
+    const QVector<GLPoint2f> &uav_shape(bool inside) const;
+
+public:
+    // fleet
+    void set_target(int id, const PreciseLandingState &st);
+    void remove_target(int id);
+    void clear_targets();
+    QList<int> target_ids() const;
+
+    void set_target_labelled(int id, bool labelled);
+
+    // the target whose marker is nearest to pos within the pick radius, -1 if none,
+    // pos in pixels of the widget, or of the area of a hosted ctrl
+    int target_at(const QPoint &pos) const;
+
+    // the hovered target gets a label like the labelled ones, -1 for none
+    void set_hovered_target(int id);
+    int hovered_target() const;
+
+    // the targets beyond the radius are picked and labelled per bearing bin, one chevron and one label a bin,
+    // the bins are numbered again and their labels dropped once the ctrl is zoomed or resized
+    int rim_bin_at(const QPoint &pos) const;
+    void set_rim_bin_labelled(int bin, bool labelled);
+    void set_hovered_rim_bin(int bin);
+    int hovered_rim_bin() const;
+
 private:
     void init_members();
     void init_ui();
@@ -44,12 +227,28 @@ private:
 
 private:
     void calc_members();
-    void calc_uav_pos();
-    void calc_distance_mark_points();
-    void calc_distance_mark_text();
+    void calc_rim_clusters();
+    void calc_hosted_viewport(const QSize &sz);
+    void sync_target_grid() const;
+
+    void show_frame();
+    void take_frame();
+    void frame_ready();
+    void rebuild_frame();
+
+    bool is_frame_unchanged();
+    VisibleState calc_visible_state(const PreciseLandingState &st, double t) const;
+    QWidget *render_widget();
+
+    void add_trail_sample(double t, const PreciseLandingState &st);
+    void calc_trail_tolerance();
 
 protected:
     void wheelEvent(QWheelEvent *e) override;
+    void changeEvent(QEvent *e) override;
+    void mousePressEvent(QMouseEvent *e) override;
+    void mouseMoveEvent(QMouseEvent *e) override;
+    void leaveEvent(QEvent *e) override;
 
 protected:
     void initializeGL() override;
@@ -57,39 +256,77 @@ protected:
     void paintGL() override;
 
 private:
-    void draw_bg();
-    void draw_axis();
-    void draw_tgt();
-    void draw_uav();
-    void draw_distance_mark();
+    void draw_static_layer();
+    void render_static_layer();
+    void release_static_layer();
+
+private:
+    void draw_raster_scene(const QSize &sz);
+    void draw_static_shapes(GLFuncUtils &gl, RenderBackend &be, int batchBase);
+    void draw_batched(GLFuncUtils &gl, RenderBackend &be, int id, void (PreciseLandingAssistCtrl::*func)(RenderBackend &));
+    void draw_stage(FrameProfiler::Stage s, void (PreciseLandingAssistCtrl::*func)(RenderBackend &), RenderBackend &be);
+
+    void draw_bg(RenderBackend &be);
+    void draw_axis(RenderBackend &be);
+    void draw_tgt(RenderBackend &be);
+    void draw_static_labels(RenderBackend &be);
+    void draw_uav(RenderBackend &be);
+    void draw_distance_mark(RenderBackend &be);
+    void draw_targets(RenderBackend &be);
+    void draw_approach_trail();
+    void draw_trail_lines(RenderBackend &be);
 
 private:
-    void draw_text(const QString &txt, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight, bool bold = true,
-                   int pixelSz = 12, const QColor &cl = Qt::white, int flags = Qt::AlignCenter);
+    void draw_text(RenderBackend &be, const QString &txt, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                   bool bold = true, int pixelSz = 12, const QColor &cl = Qt::white, int flags = Qt::AlignCenter);
+    const QFont &text_font(bool bold, int pixelSz);
+    void draw_profiler_overlay(RenderBackend &be);
 
 private:
+    // the state of the last frame built
     double      _direction;
     double      _distance;
     double      _uav_angle;
 
 private:
     // assist vars
-    bool        _uav_is_inside;
-
     double      _radius;
     double      _min_radius;
     double      _max_radius;
     double      _radius_scale_step;
 
-    QString     _str_distance;
+    // fonts of `draw_text`, by weight and pixel size
+    QVector<QFont>  _vec_text_fonts;
 
-    GLPoint2f   _uav_pos;
+    ViewportTransform       _viewport_transform;
 
     QVector<GLPoint2f>      _vec_axis_pts;
     QVector<GLPoint2f>      _vec_uav_triangle_pts;
     QVector<GLPoint2f>      _vec_uav_outside_triangle_pts;
-    QVector<GLPoint2f>      _vec_distance_lines_pts;
-    QVector<GLPoint2f>      _vec_distance_txt_pts;
+
+private:
+    // fleet
+    QHash<int, PreciseLandingState>     _hash_targets;
+    QSet<int>                           _set_labelled_targets;
+
+    // pixel positions of the markers of `_frame` for picking, brought up to date by the first pick after a frame
+    mutable TargetGrid          _target_grid;
+    mutable bool                _target_grid_synced;
+    mutable double              _target_grid_radius;    // a new radius fills the grid again
+    int                         _hovered_target;
+
+    // targets beyond the radius, one chevron and one count badge per bearing bin
+    RimClusters                 _rim_clusters;
+    bool                        _rim_clusters_stale;    // zoomed or resized, the targets are binned again
+    QSet<int>                   _set_labelled_rim_bins;
+    int                         _hovered_rim_bin;
+
+private:
+    // the geometry drawn by `paintGL`
+    FramePacket                 _frame;
+    std::atomic<bool>           _frame_pending;     // before the pipeline, a build finishing in its dtor may still set it
+    FramePipeline               _frame_pipeline;
+    bool                        _geometry_worker;
 
 private:
     GLColor3f   _cl_gray;
@@ -100,7 +337,52 @@ private:
     GLColor3f   _cl_white;
 
 private:
-    QMutex      _mtx;
+    GLGlyphAtlas    _glyph_atlas;
+
+    Backend                 _backend;
+    bool                    _gl_resolved;       // no gl call is made without the functions of the context
+    GLRenderBackend         _gl_backend;
+    RasterRenderBackend     _raster_backend;
+
+    FrameProfiler   _profiler;
+    bool            _profiler_overlay;
+
+    // commands of the frame of the last `update_ui`
+    RecordRenderBackend     _record_backend;
+    bool                    _frame_elision;
+    qint64                  _elided_frames;
+
+    // state of the last `update_ui` that was not suppressed
+    VisibleState            _visible_state;
+    bool                    _visible_dirty;
+    bool                    _update_filter;
+    qint64                  _suppressed_updates;
+
+    QWidget                 *_host;
+
+    // cached bg, axis and tgt
+    QOpenGLFramebufferObject    *_fbo_static;
+    QOpenGLFramebufferObject    *_fbo_static_ms;
+    bool                        _static_dirty;
+
+    FrameStats                  _last_frame_stats;
+    int                         _msaa_samples;
+
+private:
+    SeqLock<PreciseLandingState>    _state;
+    std::atomic<bool>               _update_pending;
+
+    DeadReckoning   _dead_reckoning;
+    bool            _dead_reckoning_enabled;
+    std::uint64_t   _state_version;
+
+    // trail of the telemetry samples, not of the prediction
+    ApproachTrail   _trail;
+    bool            _trail_enabled;
+    qint64          _trail_uploaded;
+
+    QVector<GLPoint3f>  _vec_trail_upload;
+    QVector<GLPoint2f>  _vec_trail_lines_pts;
 
 };
 
@@ -0,0 +1,291 @@
+#include "precise_landing_assist_host.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+
+
+static const int default_msaa_samples = 0;
+
+// area sizes with their own static batches, all of them are recorded again past it
+static const int max_batch_sizes = 16;
+
+
+PreciseLandingAssistHost::PreciseLandingAssistHost(QWidget *parent)
+    : QOpenGLWidget(parent), _gl_backend(this, &_glyph_atlas)
+{
+    init_members();
+    init_ui();
+    init_signal_slots();
+}
+
+PreciseLandingAssistHost::~PreciseLandingAssistHost()
+{
+    RenderScheduler::instance()->unregister_widget(this);
+
+    for (const auto &hc : _vec_ctrls)
+    {
+        hc.ctrl->set_host(nullptr);
+        hc.area->removeEventFilter(this);
+    }
+
+    // nothing was created through the unresolved functions
+    if (!_gl_resolved) return;
+
+    makeCurrent();
+    _glyph_atlas.release();
+    release_gl_buffers();
+    doneCurrent();
+}
+
+/**
+ * @brief PreciseLandingAssistHost::add_ctrl
+ * the ctrl stops drawing itself, its updates repaint the host
+ */
+void PreciseLandingAssistHost::add_ctrl(PreciseLandingAssistCtrl *ctrl, QWidget *area)
+{
+    if (!ctrl || !area) return;
+
+    remove_ctrl(ctrl);
+
+    HostedCtrl hc;
+    hc.ctrl = ctrl;
+    hc.area = area;
+    _vec_ctrls.push_back(hc);
+
+    ctrl->set_host(this);
+    area->installEventFilter(this);
+
+    QObject::connect(ctrl, &QObject::destroyed, this, [this](QObject *o)
+    {
+        forget(o);
+    });
+    QObject::connect(area, &QObject::destroyed, this, [this](QObject *o)
+    {
+        forget(o);
+    });
+
+    RenderScheduler::instance()->request_update(this);
+}
+
+void PreciseLandingAssistHost::remove_ctrl(PreciseLandingAssistCtrl *ctrl)
+{
+    for (int i = _vec_ctrls.size() - 1; i >= 0; --i)
+    {
+        const auto hc = _vec_ctrls.at(i);
+        if (hc.ctrl != ctrl) continue;
+
+        _vec_ctrls.remove(i);
+        QObject::disconnect(hc.ctrl, nullptr, this, nullptr);
+        QObject::disconnect(hc.area, nullptr, this, nullptr);
+        hc.area->removeEventFilter(this);
+        hc.ctrl->set_host(nullptr);
+    }
+
+    RenderScheduler::instance()->request_update(this);
+}
+
+int PreciseLandingAssistHost::ctrl_count() const
+{
+    return _vec_ctrls.size();
+}
+
+void PreciseLandingAssistHost::set_bg_color(const QColor &cl)
+{
+    _cl_bg = qcolor_2_gl_color3f(cl);
+    RenderScheduler::instance()->request_update(this);
+}
+
+FrameStats PreciseLandingAssistHost::last_frame_stats() const
+{
+    return _last_frame_stats;
+}
+
+/**
+ * @brief PreciseLandingAssistHost::forget
+ * a destroyed ctrl or area, nothing of it is touched
+ */
+void PreciseLandingAssistHost::forget(QObject *o)
+{
+    for (int i = _vec_ctrls.size() - 1; i >= 0; --i)
+    {
+        const auto hc = _vec_ctrls.at(i);
+        if (hc.ctrl != o && hc.area != o) continue;
+
+        _vec_ctrls.remove(i);
+
+        // the ctrl outlives its area
+        if (hc.ctrl != o) hc.ctrl->set_host(nullptr);
+    }
+
+    RenderScheduler::instance()->request_update(this);
+}
+
+void PreciseLandingAssistHost::init_members()
+{
+    _cl_bg = qcolor_2_gl_color3f(QColor(0, 0, 0));
+    _gl_resolved = false;
+}
+
+void PreciseLandingAssistHost::init_ui()
+{
+    QSurfaceFormat fmt = format();
+    fmt.setSamples(default_msaa_samples);
+    setFormat(fmt);
+}
+
+void PreciseLandingAssistHost::init_signal_slots()
+{
+    // the hosted ctrls are hidden, the scheduler does not tick them
+    RenderScheduler::instance()->register_widget(this, [this]()
+    {
+        for (const auto &hc : _vec_ctrls)
+        {
+            hc.ctrl->tick_prediction();
+        }
+    });
+}
+
+/**
+ * @brief PreciseLandingAssistHost::eventFilter
+ * dragging, resizing, showing or hiding an area repaints the host
+ */
+bool PreciseLandingAssistHost::eventFilter(QObject *o, QEvent *e)
+{
+    switch (e->type())
+    {
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::Show:
+    case QEvent::Hide:
+        RenderScheduler::instance()->request_update(this);
+        break;
+    default:
+        break;
+    }
+
+    return QOpenGLWidget::eventFilter(o, e);
+}
+
+void PreciseLandingAssistHost::initializeGL()
+{
+    _gl_resolved = initializeOpenGLFunctions();
+    if (!_gl_resolved)
+    {
+        qDebug() << "init opengl functions failed, fall back to the cpu backend";
+        return;
+    }
+
+    init_gl_buffers();
+    set_sdf_shapes(format().samples() <= 0);
+    _vec_batch_sizes.clear();
+
+    reset_color();
+}
+
+/**
+ * @brief PreciseLandingAssistHost::paintGL
+ * every area gets its own viewport and scissor, areas outside the host are skipped
+ */
+void PreciseLandingAssistHost::paintGL()
+{
+    QElapsedTimer tm;
+    tm.start();
+    reset_draw_call_count();
+
+    QOpenGLWidget::paintGL();
+
+    if (!_gl_resolved)
+    {
+        paint_raster();
+
+        _last_frame_stats.cpu_ns = tm.nsecsElapsed();
+        _last_frame_stats.draw_calls = 0;
+        _last_frame_stats.gpu_bytes = 0;
+        return;
+    }
+
+    const qreal dpr = devicePixelRatioF();
+    const QRect rcHost = rect();
+
+    glViewport(0, 0, qRound(width() * dpr), qRound(height() * dpr));
+    clear_color_buffer(_cl_bg);
+
+    glEnable(GL_SCISSOR_TEST);
+    for (const auto &hc : _vec_ctrls)
+    {
+        if (hc.area->isHidden()) continue;
+
+        const QRect rc = area_rect(hc.area);
+        if (rc.isEmpty() || !rc.intersects(rcHost)) continue;
+
+        // gl counts the rows from the bottom
+        const int x = qRound(rc.x() * dpr);
+        const int y = qRound((height() - rc.y() - rc.height()) * dpr);
+        const int w = qRound(rc.width() * dpr);
+        const int h = qRound(rc.height() * dpr);
+        glViewport(x, y, w, h);
+        glScissor(x, y, w, h);
+
+        set_viewport_size(rc.width(), rc.height());
+        hc.ctrl->render_hosted(*this, _gl_backend, rc.size(), batch_base(rc.size()));
+    }
+    glDisable(GL_SCISSOR_TEST);
+
+    glViewport(0, 0, qRound(width() * dpr), qRound(height() * dpr));
+
+    _last_frame_stats.cpu_ns = tm.nsecsElapsed();
+    _last_frame_stats.draw_calls = draw_call_count();
+    _last_frame_stats.gpu_bytes = buffer_bytes() + _glyph_atlas.texture_bytes()
+            + qint64(width() * dpr) * qint64(height() * dpr) * 8 * qMax(format().samples(), 1);
+}
+
+/**
+ * @brief PreciseLandingAssistHost::paint_raster
+ * each area drawn by the raster backend of its ctrl, the painter of the widget never uses the unresolved functions
+ */
+void PreciseLandingAssistHost::paint_raster()
+{
+    const qreal dpr = devicePixelRatioF();
+    const QRect rcHost = rect();
+
+    QPainter p(this);
+    p.fillRect(rcHost, gl_color3f_2_qcolor(_cl_bg));
+
+    for (const auto &hc : _vec_ctrls)
+    {
+        if (hc.area->isHidden()) continue;
+
+        const QRect rc = area_rect(hc.area);
+        if (rc.isEmpty() || !rc.intersects(rcHost)) continue;
+
+        p.drawImage(rc, hc.ctrl->render_hosted_image(rc.size(), dpr));
+    }
+}
+
+/**
+ * @brief PreciseLandingAssistHost::batch_base
+ * the static batches of one area size, a new size gets its own ids
+ */
+int PreciseLandingAssistHost::batch_base(const QSize &sz)
+{
+    int idx = _vec_batch_sizes.indexOf(sz);
+    if (idx < 0)
+    {
+        if (_vec_batch_sizes.size() == max_batch_sizes)
+        {
+            invalidate_batches();
+            _vec_batch_sizes.clear();
+        }
+
+        idx = _vec_batch_sizes.size();
+        _vec_batch_sizes.push_back(sz);
+    }
+
+    return idx * PreciseLandingAssistCtrl::hosted_batch_count;
+}
+
+QRect PreciseLandingAssistHost::area_rect(QWidget *area) const
+{
+    return QRect(area->mapTo(this, QPoint(0, 0)), area->size());
+}
@@ -0,0 +1,75 @@
+#ifndef PreciseLandingAssistHost_H
+#define PreciseLandingAssistHost_H
+
+#include <QOpenGLWidget>
+
+#include "precise_landing_assist_ctrl.h"
+
+
+/**
+ * @brief The PreciseLandingAssistHost class
+ * many ctrls drawn in one pass by one gl widget, each into the sub-viewport of the area widget it is placed on,
+ * one context, one framebuffer and one composition into the window for all of them,
+ * the static shapes are recorded once per area size and drawn for every ctrl of that size,
+ * the areas are children of the host and stay ordinary widgets, they keep the mouse and wheel events,
+ * without gl functions every ctrl is drawn by its raster backend and composited by a painter
+ */
+class PreciseLandingAssistHost : public QOpenGLWidget, public GLFuncUtils
+{
+public:
+    PreciseLandingAssistHost(QWidget *parent = nullptr);
+    ~PreciseLandingAssistHost() override;
+
+    // area: a descendant of the host, the ctrl is drawn over its geometry while it is not hidden
+    void add_ctrl(PreciseLandingAssistCtrl *ctrl, QWidget *area);
+    void remove_ctrl(PreciseLandingAssistCtrl *ctrl);
+    int ctrl_count() const;
+
+    void set_bg_color(const QColor &cl);
+
+    FrameStats last_frame_stats() const;
+
+private:
+    void init_members();
+    void init_ui();
+    void init_signal_slots();
+
+protected:
+    bool eventFilter(QObject *o, QEvent *e) override;
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    void paint_raster();
+    void forget(QObject *o);
+    int batch_base(const QSize &sz);
+    QRect area_rect(QWidget *area) const;
+
+private:
+    struct HostedCtrl
+    {
+        PreciseLandingAssistCtrl    *ctrl;
+        QWidget                     *area;
+    };
+
+private:
+    QVector<HostedCtrl>     _vec_ctrls;
+
+    GLColor3f       _cl_bg;
+
+    GLGlyphAtlas    _glyph_atlas;
+    GLRenderBackend _gl_backend;
+
+    // area sizes the static batches are recorded for, the index gives the batch base
+    QVector<QSize>  _vec_batch_sizes;
+
+    FrameStats      _last_frame_stats;
+
+    bool            _gl_resolved;
+
+
+};
+
+#endif // PreciseLandingAssistHost_H
@@ -0,0 +1,20 @@
+#ifndef PRECISE_LANDING_STATE_H
+#define PRECISE_LANDING_STATE_H
+
+
+/**
+ * @brief The PreciseLandingState struct
+ * telemetry published to the ctrl as a whole
+ */
+struct PreciseLandingState
+{
+    double      distance;
+    double      direction;
+    double      uav_angle;
+
+    PreciseLandingState(double tmpDistance = 0, double tmpDirection = 0, double tmpUavAngle = 0)
+        : distance(tmpDistance), direction(tmpDirection), uav_angle(tmpUavAngle)
+    {}
+};
+
+#endif // PRECISE_LANDING_STATE_H
@@ -0,0 +1,353 @@
+#include "raster_render_backend.h"
+
+#include <QPainter>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+static const float line_half_width = 0.5f;      // pixel, as the gl lines
+static const int marker_shape_count = 2;
+
+
+// x * a / 255 for all four channels
+static inline quint32 byte_mul(quint32 x, quint32 a)
+{
+    quint32 t = (x & 0xff00ff) * a;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+
+    x = ((x >> 8) & 0xff00ff) * a;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+
+    return x | t;
+}
+
+// source over of a premultiplied color
+static inline quint32 blend_over(quint32 dst, quint32 src)
+{
+    return src + byte_mul(dst, 255 - (src >> 24));
+}
+
+// half width of the ellipse at row offset dy, negative if the row misses it
+static inline float ellipse_half_width(float rx, float ry, float dy)
+{
+    if (rx <= 0 || ry <= 0 || std::fabs(dy) >= ry) return -1;
+
+    const float v = dy / ry;
+    return rx * std::sqrt(1 - v*v);
+}
+
+/**
+ * @brief ellipse_distance
+ * signed distance in pixels from (dx, dy) to the ellipse, first order, exact for circles
+ */
+static inline float ellipse_distance(float rx, float ry, float dx, float dy)
+{
+    const float u = dx / rx;
+    const float v = dy / ry;
+    const float len = std::sqrt(u*u + v*v);
+    if (len <= 0) return -qMin(rx, ry);
+
+    const float grad = std::sqrt(u*u / (rx*rx) + v*v / (ry*ry)) / len;
+    return (len - 1) / grad;
+}
+
+
+RasterRenderBackend::RasterRenderBackend()
+    : _color(Qt::white), _premul(0xffffffff)
+{
+}
+
+void RasterRenderBackend::begin_frame(int w, int h, const GLColor3f &clBg)
+{
+    if (_img.width() != w || _img.height() != h)
+    {
+        _img = QImage(w, h, QImage::Format_ARGB32_Premultiplied);
+        _transform.set_viewport(QRect(0, 0, w, h));
+    }
+
+    _img.fill(QColor::fromRgbF(clBg.r, clBg.g, clBg.b));
+}
+
+void RasterRenderBackend::end_frame()
+{
+}
+
+void RasterRenderBackend::set_color(const GLColor4f &cl)
+{
+    _color = QColor::fromRgbF(qBound(0.0f, cl.r, 1.0f), qBound(0.0f, cl.g, 1.0f),
+                              qBound(0.0f, cl.b, 1.0f), qBound(0.0f, cl.a, 1.0f));
+    _premul = qPremultiply(_color.rgba());
+}
+
+void RasterRenderBackend::draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    fill_ellipse(ptCenter, rx, ry, -1e9f, 0);
+}
+
+void RasterRenderBackend::draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    fill_ellipse(ptCenter, rx, ry, -line_half_width, line_half_width);
+}
+
+void RasterRenderBackend::draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode)
+{
+    if (vecPts.size() < 2) return;
+
+    QPainter p(&_img);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(QPen(_color, 2 * line_half_width));
+
+    _poly.resize(vecPts.size());
+    _transform.to_pixels(vecPts.constData(), _poly.data(), vecPts.size());
+
+    if (mode == GL_LINES)
+    {
+        p.drawLines(_poly.constData(), _poly.size() / 2);
+        return;
+    }
+
+    p.drawPolyline(_poly.constData(), _poly.size());
+}
+
+void RasterRenderBackend::draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle)
+{
+    if (vecPts.size() != 3) return;
+
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+
+    GLPoint2f vertices[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto &v = vecPts.at(i);
+        vertices[i] = GLPoint2f(c*v.x - s*v.y + pos.x, s*v.x + c*v.y + pos.y);
+    }
+
+    QPointF pts[3];
+    _transform.to_pixels(vertices, pts, 3);
+
+    QPainter p(&_img);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(Qt::NoPen);
+    p.setBrush(_color);
+    p.drawPolygon(pts, 3);
+}
+
+void RasterRenderBackend::set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts)
+{
+    if (shape < 0 || shape >= marker_shape_count || vecPts.size() != 3) return;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        _marker_shapes[shape*3 + i] = vecPts.at(i);
+    }
+}
+
+void RasterRenderBackend::draw_markers(const QVector<GLMarkerInstance> &vecInstances)
+{
+    if (vecInstances.isEmpty()) return;
+
+    QPainter p(&_img);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(Qt::NoPen);
+    p.setBrush(_color);
+
+    for (const auto &m : vecInstances)
+    {
+        const int shape = qBound(0, static_cast<int>(m.shape), marker_shape_count - 1);
+        const float c = std::cos(m.angle);
+        const float s = std::sin(m.angle);
+
+        GLPoint2f vertices[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto &v = _marker_shapes[shape*3 + i];
+            vertices[i] = GLPoint2f(c*v.x - s*v.y + m.x, s*v.x + c*v.y + m.y);
+        }
+
+        QPointF pts[3];
+        _transform.to_pixels(vertices, pts, 3);
+        p.drawPolygon(pts, 3);
+    }
+}
+
+void RasterRenderBackend::draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                                    int flags)
+{
+    if (txt.isEmpty()) return;
+
+    QPainter p(&_img);
+    p.setRenderHint(QPainter::TextAntialiasing);
+    p.setFont(f);
+    p.setPen(_color);
+    p.drawText(QRectF(_transform.to_pixel(ptTopLeft), _transform.to_pixel(ptBottomRight)), flags, txt);
+}
+
+const QImage &RasterRenderBackend::image() const
+{
+    return _img;
+}
+
+/**
+ * @brief RasterRenderBackend::fill_ellipse
+ * each row is split into the fully covered spans, filled with `fill_span`,
+ * and the edge pixels around them, blended with their coverage, the hole of a ring is skipped
+ * @param dIn: inner edge of the shape, a very small value fills the whole ellipse
+ * @param dOut: outer edge of the shape
+ */
+void RasterRenderBackend::fill_ellipse(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, float dIn, float dOut)
+{
+    if (_img.isNull() || _color.alpha() == 0) return;
+
+    const float w = _img.width();
+    const float h = _img.height();
+    const QPointF ptPixel = _transform.to_pixel(ptCenter);
+    const float cx = static_cast<float>(ptPixel.x());
+    const float cy = static_cast<float>(ptPixel.y());
+    const float prx = std::fabs(rx) * w / 2;
+    const float pry = std::fabs(ry) * h / 2;
+    if (prx <= 0 || pry <= 0) return;
+
+    const bool hasHole = (dIn > -qMin(prx, pry));
+
+    const int y1 = qMax(0, static_cast<int>(std::floor(cy - pry - dOut - 1)));
+    const int y2 = qMin(_img.height() - 1, static_cast<int>(std::ceil(cy + pry + dOut + 1)));
+
+    for (int y = y1; y <= y2; ++y)
+    {
+        const float dy = y + 0.5f - cy;
+
+        // everything that may be touched, what is surely covered, and the hole that is surely not
+        const float outer = ellipse_half_width(prx + dOut + 1, pry + dOut + 1, dy);
+        if (outer < 0) continue;
+
+        const float fullOut = ellipse_half_width(prx + dOut - 1, pry + dOut - 1, dy);
+        const float fullIn = (hasHole ? ellipse_half_width(prx + dIn + 1, pry + dIn + 1, dy) : -1);
+        const float emptyIn = (hasHole ? ellipse_half_width(prx + dIn - 1, pry + dIn - 1, dy) : -1);
+
+        auto row = reinterpret_cast<quint32 *>(_img.scanLine(y));
+
+        const int x1 = qMax(0, static_cast<int>(std::floor(cx - outer)));
+        const int x2 = qMin(_img.width() - 1, static_cast<int>(std::ceil(cx + outer)));
+
+        // full spans in pixel index, [a1, a2] left and [b1, b2] right, one span without a hole
+        int a1 = 1, a2 = 0, b1 = 1, b2 = 0;
+        if (fullOut > 0)
+        {
+            const int left = static_cast<int>(std::ceil(cx - fullOut - 0.5f));
+            const int right = static_cast<int>(std::floor(cx + fullOut - 0.5f));
+
+            a1 = left;
+            if (fullIn >= 0)
+            {
+                a2 = static_cast<int>(std::floor(cx - fullIn - 0.5f));
+                b1 = static_cast<int>(std::ceil(cx + fullIn - 0.5f));
+                b2 = right;
+            }
+            else
+            {
+                a2 = right;
+            }
+        }
+
+        // the hole in pixel index, a thin ring has no full span, only its two edge bands are evaluated
+        int e1 = 1, e2 = 0;
+        if (emptyIn > 0)
+        {
+            e1 = static_cast<int>(std::ceil(cx - emptyIn - 0.5f));
+            e2 = static_cast<int>(std::floor(cx + emptyIn - 0.5f));
+        }
+
+        for (int x = x1; x <= x2; ++x)
+        {
+            if (x >= e1 && x <= e2)
+            {
+                x = e2;
+                continue;
+            }
+            if (x >= a1 && x <= a2)
+            {
+                fill_span(row, x, qMin(a2, x2));
+                x = a2;
+                continue;
+            }
+            if (x >= b1 && x <= b2)
+            {
+                fill_span(row, x, qMin(b2, x2));
+                x = b2;
+                continue;
+            }
+
+            const float d = ellipse_distance(prx, pry, x + 0.5f - cx, dy);
+            const float coverage = qMin(0.5f - (d - dOut), 0.5f + (d - dIn));
+            if (coverage <= 0) continue;
+
+            blend_pixel(row + x, qMin(coverage, 1.0f));
+        }
+    }
+}
+
+/**
+ * @brief RasterRenderBackend::fill_span
+ * fill [x1, x2] with the current color, four pixels at a time
+ */
+void RasterRenderBackend::fill_span(quint32 *row, int x1, int x2)
+{
+    int x = qMax(x1, 0);
+    const quint32 src = _premul;
+    const quint32 alpha = src >> 24;
+
+    if (alpha == 255)
+    {
+#ifdef RASTER_USE_SSE2
+        const __m128i c = _mm_set1_epi32(static_cast<int>(src));
+        for (; x + 3 <= x2; x += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), c);
+        }
+#endif
+        for (; x <= x2; ++x)
+        {
+            row[x] = src;
+        }
+        return;
+    }
+
+#ifdef RASTER_USE_SSE2
+    // dst * (255 - a) / 255 + src, on 16 bit lanes
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i inv = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    const __m128i half = _mm_set1_epi16(0x80);
+    const __m128i c = _mm_set1_epi32(static_cast<int>(src));
+    for (; x + 3 <= x2; x += 4)
+    {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x));
+
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv);
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv);
+        lo = _mm_add_epi16(lo, half);
+        hi = _mm_add_epi16(hi, half);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), _mm_adds_epu8(_mm_packus_epi16(lo, hi), c));
+    }
+#endif
+    for (; x <= x2; ++x)
+    {
+        row[x] = blend_over(row[x], src);
+    }
+}
+
+void RasterRenderBackend::blend_pixel(quint32 *px, float coverage)
+{
+    const quint32 a = static_cast<quint32>(coverage * 255 + 0.5f);
+    *px = blend_over(*px, byte_mul(_premul, a));
+}
@@ -0,0 +1,65 @@
+#ifndef RASTER_RENDER_BACKEND_H
+#define RASTER_RENDER_BACKEND_H
+
+#include <QImage>
+#include <QPolygonF>
+
+#include "render_backend.h"
+#include "viewport_transform.h"
+
+
+/**
+ * @brief The RasterRenderBackend class
+ * the scene rendered on the cpu into a premultiplied argb32 image, for consoles without a usable gl,
+ * discs and rings are filled span by span with analytic anti-aliased edges, the inner spans with simd,
+ * lines, triangles and text go through QPainter
+ */
+class RasterRenderBackend : public RenderBackend
+{
+public:
+    RasterRenderBackend();
+
+    using RenderBackend::set_color;
+
+    void begin_frame(int w, int h, const GLColor3f &clBg) override;
+    void end_frame() override;
+
+    void set_color(const GLColor4f &cl) override;
+
+    void draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode) override;
+    void draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle) override;
+
+    void set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts) override;
+    void draw_markers(const QVector<GLMarkerInstance> &vecInstances) override;
+
+    void draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                   int flags) override;
+
+    // valid until the next `begin_frame`
+    const QImage &image() const;
+
+private:
+    // signed distance to the ellipse, in pixels, between dIn and dOut is inside the shape
+    void fill_ellipse(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry, float dIn, float dOut);
+    void fill_span(quint32 *row, int x1, int x2);
+    void blend_pixel(quint32 *px, float coverage);
+
+private:
+    QImage      _img;
+
+    // of the image, rebuilt when its size changes
+    ViewportTransform   _transform;
+
+    // pixels of the shape being drawn
+    QPolygonF   _poly;
+
+    QColor      _color;
+    quint32     _premul;
+
+    GLPoint2f   _marker_shapes[6];
+
+};
+
+#endif // RASTER_RENDER_BACKEND_H
@@ -0,0 +1,156 @@
+#include "record_render_backend.h"
+
+#include <cstring>
+
+
+RecordRenderBackend::RecordRenderBackend()
+{
+}
+
+void RecordRenderBackend::begin_frame(int w, int h, const GLColor3f &clBg)
+{
+    _vec_words.resize(0);
+
+    append(static_cast<quint32>(CmdFrame));
+    append(static_cast<quint32>(w));
+    append(static_cast<quint32>(h));
+    append(clBg.r);
+    append(clBg.g);
+    append(clBg.b);
+}
+
+void RecordRenderBackend::end_frame()
+{
+}
+
+void RecordRenderBackend::set_color(const GLColor4f &cl)
+{
+    append(static_cast<quint32>(CmdColor));
+    append(cl.r);
+    append(cl.g);
+    append(cl.b);
+    append(cl.a);
+}
+
+void RecordRenderBackend::draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    append(static_cast<quint32>(CmdDisc));
+    append(ptCenter);
+    append(rx);
+    append(ry);
+}
+
+void RecordRenderBackend::draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry)
+{
+    append(static_cast<quint32>(CmdRing));
+    append(ptCenter);
+    append(rx);
+    append(ry);
+}
+
+void RecordRenderBackend::draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode)
+{
+    append(static_cast<quint32>(CmdLines));
+    append(static_cast<quint32>(mode));
+    append(static_cast<quint32>(vecPts.size()));
+    append(&vecPts.constData()->x, vecPts.size() * 2);
+}
+
+void RecordRenderBackend::draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle)
+{
+    append(static_cast<quint32>(CmdTriangle));
+    append(static_cast<quint32>(vecPts.size()));
+    append(&vecPts.constData()->x, vecPts.size() * 2);
+    append(pos);
+    append(angle);
+}
+
+void RecordRenderBackend::set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts)
+{
+    append(static_cast<quint32>(CmdMarkerShape));
+    append(static_cast<quint32>(shape));
+    append(static_cast<quint32>(vecPts.size()));
+    append(&vecPts.constData()->x, vecPts.size() * 2);
+}
+
+void RecordRenderBackend::draw_markers(const QVector<GLMarkerInstance> &vecInstances)
+{
+    append(static_cast<quint32>(CmdMarkers));
+    append(static_cast<quint32>(vecInstances.size()));
+
+    for (const auto &inst : vecInstances)
+    {
+        append(inst.x);
+        append(inst.y);
+        append(inst.angle);
+        append(inst.shape);
+    }
+}
+
+void RecordRenderBackend::draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft,
+                                    const GLPoint2f &ptBottomRight, int flags)
+{
+    append(static_cast<quint32>(CmdText));
+    append(static_cast<quint32>(f.pixelSize()));
+    append(static_cast<quint32>(f.weight()));
+    append(static_cast<quint32>(flags));
+    append(ptTopLeft);
+    append(ptBottomRight);
+
+    // two utf-16 units a word
+    const int len = txt.size();
+    append(static_cast<quint32>(len));
+    for (int i = 0; i < len; i += 2)
+    {
+        const quint32 lo = txt.at(i).unicode();
+        const quint32 hi = (i + 1 < len ? txt.at(i + 1).unicode() : 0);
+        append(lo | (hi << 16));
+    }
+}
+
+void RecordRenderBackend::record_key(qint64 key)
+{
+    append(static_cast<quint32>(CmdKey));
+    append(static_cast<quint32>(key));
+    append(static_cast<quint32>(static_cast<quint64>(key) >> 32));
+}
+
+const QVector<quint32> &RecordRenderBackend::commands() const
+{
+    return _vec_words;
+}
+
+bool RecordRenderBackend::swap_and_compare()
+{
+    const bool same = (_vec_words.size() == _vec_last_words.size()
+                       && std::memcmp(_vec_words.constData(), _vec_last_words.constData(),
+                                      static_cast<size_t>(_vec_words.size()) * sizeof(quint32)) == 0);
+
+    _vec_words.swap(_vec_last_words);
+    return same;
+}
+
+void RecordRenderBackend::append(quint32 w)
+{
+    _vec_words.push_back(w);
+}
+
+void RecordRenderBackend::append(GLfloat f)
+{
+    quint32 w;
+    std::memcpy(&w, &f, sizeof(w));
+    _vec_words.push_back(w);
+}
+
+void RecordRenderBackend::append(const GLPoint2f &pt)
+{
+    append(pt.x);
+    append(pt.y);
+}
+
+void RecordRenderBackend::append(const GLfloat *fs, int count)
+{
+    const int first = _vec_words.size();
+    _vec_words.resize(first + count);
+    if (count > 0) std::memcpy(_vec_words.data() + first, fs, static_cast<size_t>(count) * sizeof(quint32));
+}
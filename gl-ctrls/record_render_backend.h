@@ -0,0 +1,71 @@
+#ifndef RECORD_RENDER_BACKEND_H
+#define RECORD_RENDER_BACKEND_H
+
+#include "render_backend.h"
+
+
+/**
+ * @brief The RecordRenderBackend class
+ * nothing is drawn, every command with its arguments is appended to a compact list of 32 bit words,
+ * two frames that record the same words draw the same pixels,
+ * the storage of the list is kept between frames
+ */
+class RecordRenderBackend : public RenderBackend
+{
+public:
+    RecordRenderBackend();
+
+    using RenderBackend::set_color;
+
+    void begin_frame(int w, int h, const GLColor3f &clBg) override;
+    void end_frame() override;
+
+    void set_color(const GLColor4f &cl) override;
+
+    void draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) override;
+    void draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode) override;
+    void draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle) override;
+
+    void set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts) override;
+    void draw_markers(const QVector<GLMarkerInstance> &vecInstances) override;
+
+    void draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                   int flags) override;
+
+    // state that changes the frame without a command of its own
+    void record_key(qint64 key);
+
+    const QVector<quint32> &commands() const;
+
+    // true if the frame just recorded equals the one before it, the recorded frame becomes the one before
+    bool swap_and_compare();
+
+private:
+    enum Command
+    {
+        CmdFrame = 1,
+        CmdColor,
+        CmdDisc,
+        CmdRing,
+        CmdLines,
+        CmdTriangle,
+        CmdMarkerShape,
+        CmdMarkers,
+        CmdText,
+        CmdKey
+    };
+
+private:
+    void append(quint32 w);
+    void append(GLfloat f);
+    void append(const GLPoint2f &pt);
+    void append(const GLfloat *fs, int count);
+
+private:
+    QVector<quint32>    _vec_words;
+    QVector<quint32>    _vec_last_words;
+
+};
+
+#endif // RECORD_RENDER_BACKEND_H
@@ -0,0 +1,48 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include <QFont>
+#include <QString>
+#include <QVector>
+
+#include "gl_utils.h"
+
+
+/**
+ * @brief The RenderBackend class
+ * drawing api of the ctrl scene, every coordinate is a gl coordinate of range [-1, 1], y up,
+ * the shapes are drawn in the current color
+ */
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() {}
+
+    // w, h: pixel size of the frame
+    virtual void begin_frame(int w, int h, const GLColor3f &clBg) = 0;
+    virtual void end_frame() = 0;
+
+    virtual void set_color(const GLColor4f &cl) = 0;
+    void set_color(const GLColor3f &cl)
+    {
+        set_color(GLColor4f(cl.r, cl.g, cl.b, 1));
+    }
+
+    virtual void draw_disc(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) = 0;
+    virtual void draw_ring(const GLPoint2f &ptCenter, GLfloat rx, GLfloat ry) = 0;
+
+    // mode: GL_LINES or GL_LINE_STRIP
+    virtual void draw_lines(const QVector<GLPoint2f> &vecPts, GLenum mode) = 0;
+
+    // angle: counterclockwise rotation in radian around the origin of the triangle, then moved to pos
+    virtual void draw_triangle(const QVector<GLPoint2f> &vecPts, const GLPoint2f &pos, GLfloat angle) = 0;
+
+    virtual void set_marker_shape(int shape, const QVector<GLPoint2f> &vecPts) = 0;
+    virtual void draw_markers(const QVector<GLMarkerInstance> &vecInstances) = 0;
+
+    virtual void draw_text(const QString &txt, const QFont &f, const GLPoint2f &ptTopLeft, const GLPoint2f &ptBottomRight,
+                           int flags) = 0;
+
+};
+
+#endif // RENDER_BACKEND_H
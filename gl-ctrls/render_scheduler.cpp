@@ -0,0 +1,158 @@
+#include "render_scheduler.h"
+
+
+static const int default_frame_rate = 60;
+static const int idle_interval_ms = 250;
+
+
+RenderScheduler *RenderScheduler::instance()
+{
+    static RenderScheduler scheduler;
+    return &scheduler;
+}
+
+RenderScheduler::RenderScheduler()
+    : _frame_rate(default_frame_rate), _idle(false)
+{
+    _clock.start();
+
+    _tm_frame.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&_tm_frame, &QTimer::timeout, [this]()
+    {
+        tick();
+    });
+}
+
+void RenderScheduler::register_widget(QWidget *w, const tick_func &func, int intervalMs)
+{
+    if (!w) return;
+
+    Client c;
+    c.widget = w;
+    c.func = func;
+    c.interval_ms = (intervalMs > 0 ? intervalMs : 0);
+    c.last_ms = _clock.elapsed();
+    _vec_clients.push_back(c);
+
+    watch(w);
+    update_timer(true);
+}
+
+void RenderScheduler::unregister_widget(QWidget *w)
+{
+    for (int i = _vec_clients.size() - 1; i >= 0; --i)
+    {
+        if (_vec_clients.at(i).widget == w)
+        {
+            _vec_clients.remove(i);
+        }
+    }
+
+    _vec_dirty.removeAll(w);
+
+    if (_vec_clients.isEmpty() && _vec_dirty.isEmpty())
+    {
+        _tm_frame.stop();
+    }
+}
+
+void RenderScheduler::request_update(QWidget *w)
+{
+    if (!w) return;
+
+    watch(w);
+    if (!_vec_dirty.contains(w)) _vec_dirty.push_back(w);
+    update_timer(true);
+}
+
+void RenderScheduler::set_frame_rate(int fps)
+{
+    if (fps <= 0) return;
+
+    _frame_rate = fps;
+    if (_tm_frame.isActive()) update_timer(!_idle);
+}
+
+int RenderScheduler::frame_rate() const
+{
+    return _frame_rate;
+}
+
+void RenderScheduler::tick()
+{
+    const qint64 now = _clock.elapsed();
+    const qint64 halfFrame = 500 / _frame_rate;
+    bool active = false;
+
+    for (int i = 0; i < _vec_clients.size(); ++i)
+    {
+        auto &c = _vec_clients[i];
+        if (!is_shown(c.widget)) continue;
+
+        active = true;
+
+        // align to the frame ticks, a tick half a frame early is on time
+        if (now - c.last_ms + halfFrame < c.interval_ms) continue;
+
+        c.last_ms = now;
+
+        // the function may unregister clients, keep a copy
+        auto func = c.func;
+        func();
+    }
+
+    // one update pass for every widget dirtied during this frame, hidden ones stay dirty
+    _vec_dirty_pass.swap(_vec_dirty);
+    _vec_dirty.clear();
+    for (auto w : _vec_dirty_pass)
+    {
+        if (!is_shown(w))
+        {
+            if (!_vec_dirty.contains(w)) _vec_dirty.push_back(w);
+            continue;
+        }
+
+        w->update();
+        active = true;
+    }
+    _vec_dirty_pass.clear();
+
+    if (_vec_clients.isEmpty() && _vec_dirty.isEmpty())
+    {
+        _tm_frame.stop();
+        return;
+    }
+
+    update_timer(active);
+}
+
+void RenderScheduler::update_timer(bool active)
+{
+    const int interval = (active ? 1000 / _frame_rate : idle_interval_ms);
+
+    _idle = !active;
+    if (_tm_frame.isActive() && _tm_frame.interval() == interval) return;
+
+    _tm_frame.start(interval);
+}
+
+/**
+ * @brief RenderScheduler::watch
+ * forget the widget when it is destroyed
+ */
+void RenderScheduler::watch(QWidget *w)
+{
+    if (_set_watched.contains(w)) return;
+
+    _set_watched.insert(w);
+    QObject::connect(w, &QObject::destroyed, [this, w]()
+    {
+        _set_watched.remove(w);
+        unregister_widget(w);
+    });
+}
+
+bool RenderScheduler::is_shown(QWidget *w)
+{
+    return (w->isVisible() && !w->window()->isMinimized());
+}
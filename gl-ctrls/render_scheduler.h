@@ -0,0 +1,72 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QVector>
+#include <QSet>
+#include <QElapsedTimer>
+
+#include <functional>
+
+
+/**
+ * @brief The RenderScheduler class
+ * one process wide frame timer instead of a timer per widget,
+ * every tick runs the due tick functions, then repaints the dirty widgets in one pass,
+ * hidden or minimized widgets are not ticked, with none visible the timer slows down to the idle rate,
+ * use it in the gui thread only
+ */
+class RenderScheduler
+{
+public:
+    typedef std::function<void ()>  tick_func;
+
+public:
+    static RenderScheduler *instance();
+
+    // intervalMs: 0 ticks every frame, otherwise on the first frame after the interval
+    void register_widget(QWidget *w, const tick_func &func, int intervalMs = 0);
+    void unregister_widget(QWidget *w);
+
+    // repaint on the next tick, requests of the same frame are coalesced
+    void request_update(QWidget *w);
+
+    void set_frame_rate(int fps);
+    int frame_rate() const;
+
+private:
+    RenderScheduler();
+
+    void tick();
+    void update_timer(bool active);
+    void watch(QWidget *w);
+
+    static bool is_shown(QWidget *w);
+
+private:
+    struct Client
+    {
+        QWidget     *widget;
+        tick_func   func;
+        qint64      interval_ms;
+        qint64      last_ms;
+    };
+
+private:
+    QTimer          _tm_frame;
+    QElapsedTimer   _clock;
+
+    int             _frame_rate;
+    bool            _idle;
+
+    QVector<Client>     _vec_clients;
+    QSet<QWidget *>     _set_watched;
+
+    // a list instead of a set, a request does not allocate a node, the storage is kept between ticks
+    QVector<QWidget *>  _vec_dirty;
+    QVector<QWidget *>  _vec_dirty_pass;
+
+};
+
+#endif // RENDER_SCHEDULER_H
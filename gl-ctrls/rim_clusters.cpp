@@ -0,0 +1,127 @@
+#include "rim_clusters.h"
+
+#include <cmath>
+
+
+static const double TWO_PI = 2 * 3.14159265358979323846;
+
+
+RimClusters::RimClusters()
+{
+    set_bin_count(1);
+}
+
+void RimClusters::set_bin_count(int n)
+{
+    n = qMax(n, 1);
+
+    const Bin empty = {0, 0, 0};
+    _vec_bins.fill(empty, n);
+
+    for (auto it = _hash_members.begin(); it != _hash_members.end(); ++it)
+    {
+        it->bin = bin_of(it->direction);
+        add(it->bin, it->direction, 1);
+    }
+}
+
+int RimClusters::bin_count() const
+{
+    return _vec_bins.size();
+}
+
+void RimClusters::update(int id, double direction, bool outside)
+{
+    if (!outside)
+    {
+        remove(id);
+        return;
+    }
+
+    auto it = _hash_members.find(id);
+    if (it == _hash_members.end())
+    {
+        Member m;
+        m.direction = direction;
+        m.bin = bin_of(direction);
+        _hash_members.insert(id, m);
+
+        add(m.bin, direction, 1);
+        return;
+    }
+
+    if (it->direction == direction) return;
+
+    add(it->bin, it->direction, -1);
+    it->direction = direction;
+    it->bin = bin_of(direction);
+    add(it->bin, direction, 1);
+}
+
+void RimClusters::remove(int id)
+{
+    auto it = _hash_members.find(id);
+    if (it == _hash_members.end()) return;
+
+    add(it->bin, it->direction, -1);
+    _hash_members.erase(it);
+}
+
+void RimClusters::clear()
+{
+    _hash_members.clear();
+
+    const Bin empty = {0, 0, 0};
+    _vec_bins.fill(empty);
+}
+
+int RimClusters::member_count() const
+{
+    return _hash_members.size();
+}
+
+int RimClusters::count(int bin) const
+{
+    return _vec_bins.at(bin).count;
+}
+
+int RimClusters::bin_of_member(int id) const
+{
+    auto it = _hash_members.constFind(id);
+    return (it == _hash_members.constEnd() ? -1 : it->bin);
+}
+
+double RimClusters::direction(int bin) const
+{
+    const Bin &b = _vec_bins.at(bin);
+    return std::atan2(b.sum_sin, b.sum_cos);
+}
+
+int RimClusters::bin_of(double direction) const
+{
+    double a = std::fmod(direction, TWO_PI);
+    if (a < 0) a += TWO_PI;
+
+    const int n = _vec_bins.size();
+    return qMin(static_cast<int>(a / TWO_PI * n), n - 1);
+}
+
+/**
+ * @brief RimClusters::add
+ * the sums of an emptied bin are reset, no rounding error is left behind
+ */
+void RimClusters::add(int bin, double direction, int sign)
+{
+    Bin &b = _vec_bins[bin];
+    b.count += sign;
+
+    if (b.count == 0)
+    {
+        b.sum_sin = 0;
+        b.sum_cos = 0;
+        return;
+    }
+
+    b.sum_sin += sign * std::sin(direction);
+    b.sum_cos += sign * std::cos(direction);
+}
@@ -0,0 +1,60 @@
+#ifndef RIM_CLUSTERS_H
+#define RIM_CLUSTERS_H
+
+#include <QVector>
+#include <QHash>
+
+
+/**
+ * @brief The RimClusters class
+ * targets beyond the radius binned by bearing, one chevron is drawn per occupied bin,
+ * a bin keeps the count and the summed unit vectors of its members, a move changes only the bins it leaves and enters
+ */
+class RimClusters
+{
+public:
+    RimClusters();
+
+    // the members are binned again
+    void set_bin_count(int n);
+    int bin_count() const;
+
+    // direction: radian, a target that is not outside leaves its bin
+    void update(int id, double direction, bool outside);
+    void remove(int id);
+    void clear();
+
+    int member_count() const;
+    int count(int bin) const;
+
+    // the bin of a target beyond the radius, -1 if it is not outside
+    int bin_of_member(int id) const;
+
+    // mean bearing of the members of a bin, radian
+    double direction(int bin) const;
+
+private:
+    int bin_of(double direction) const;
+    void add(int bin, double direction, int sign);
+
+private:
+    struct Member
+    {
+        double  direction;
+        int     bin;
+    };
+
+    struct Bin
+    {
+        int     count;
+        double  sum_sin;
+        double  sum_cos;
+    };
+
+private:
+    QHash<int, Member>  _hash_members;
+    QVector<Bin>        _vec_bins;
+
+};
+
+#endif // RIM_CLUSTERS_H
@@ -0,0 +1,107 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+/**
+ * @brief The SeqLock class
+ * one value published by any thread and read by any thread,
+ * readers never block writers and never see a torn value,
+ * writers only wait for each other for the duration of one copy
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock(const T &val = T())
+        : _seq(0)
+    {
+        write_words(val);
+    }
+
+    void store(const T &val)
+    {
+        // take the writer slot, an odd sequence marks a write in progress
+        auto seq = _seq.load(std::memory_order_relaxed);
+        while ((seq & 1) || !_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            seq = _seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        write_words(val);
+
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        std::uint64_t ver;
+        return load(ver);
+    }
+
+    // ver: the version the value was stored with
+    T load(std::uint64_t &ver) const
+    {
+        T val;
+        for (;;)
+        {
+            auto seq1 = _seq.load(std::memory_order_acquire);
+            if (seq1 & 1) continue;
+
+            read_words(val);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto seq2 = _seq.load(std::memory_order_relaxed);
+            if (seq1 == seq2)
+            {
+                ver = seq1 >> 1;
+                return val;
+            }
+        }
+    }
+
+    // count of completed stores
+    std::uint64_t version() const
+    {
+        return _seq.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    void write_words(const T &val)
+    {
+        std::uint64_t words[word_count] = {};
+        std::memcpy(words, &val, sizeof(T));
+
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    void read_words(T &val) const
+    {
+        std::uint64_t words[word_count];
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+
+        std::memcpy(&val, words, sizeof(T));
+    }
+
+private:
+    static const std::size_t word_count = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t>  _seq;
+    std::atomic<std::uint64_t>  _words[word_count];
+
+};
+
+#endif // SEQ_LOCK_H
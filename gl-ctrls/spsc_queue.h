@@ -0,0 +1,63 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+
+/**
+ * @brief The SpscQueue class
+ * bounded ring of values pushed by one thread and popped by one other thread, neither ever blocks,
+ * the producer may move from thread to thread if each push happens after the last one, the same for the consumer,
+ * one slot is kept empty to tell full from empty
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue needs a trivially copyable type");
+
+public:
+    SpscQueue()
+        : _head(0), _tail(0)
+    {}
+
+    // false if the queue is full
+    bool push(const T &val)
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        const auto next = (tail + 1) % slot_count;
+        if (next == _head.load(std::memory_order_acquire)) return false;
+
+        _slots[tail] = val;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // false if the queue is empty
+    bool pop(T &val)
+    {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+
+        val = _slots[head];
+        _head.store((head + 1) % slot_count, std::memory_order_release);
+        return true;
+    }
+
+    bool is_empty() const
+    {
+        return (_head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire));
+    }
+
+private:
+    static const std::size_t slot_count = Capacity + 1;
+
+    std::atomic<std::size_t>    _head;      // written by the consumer
+    std::atomic<std::size_t>    _tail;      // written by the producer
+
+    T   _slots[slot_count];
+
+};
+
+#endif // SPSC_QUEUE_H
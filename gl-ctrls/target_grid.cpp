@@ -0,0 +1,205 @@
+#include "target_grid.h"
+
+#include <cmath>
+
+
+TargetGrid::TargetGrid()
+    : _cell_size(1.0), _cols(1), _rows(1), _bulk(false)
+{
+    _vec_cells.resize(1);
+}
+
+void TargetGrid::set_bounds(const QRectF &rc, double cellSize)
+{
+    _rc_bounds = rc;
+    _cell_size = qMax(cellSize, 1.0);
+    _cols = qMax(1, static_cast<int>(std::ceil(rc.width() / _cell_size)));
+    _rows = qMax(1, static_cast<int>(std::ceil(rc.height() / _cell_size)));
+
+    if (_vec_cells.size() != _cols * _rows) _vec_cells.resize(_cols * _rows);
+    if (!_bulk) rebin_all();
+}
+
+const QRectF &TargetGrid::bounds() const
+{
+    return _rc_bounds;
+}
+
+/**
+ * @brief TargetGrid::update
+ * an unknown id is inserted
+ */
+void TargetGrid::update(int id, const QPointF &pt)
+{
+    auto it = _hash_index.find(id);
+    if (it == _hash_index.end())
+    {
+        Item item;
+        item.id = id;
+        item.x = pt.x();
+        item.y = pt.y();
+        item.cell = -1;
+        item.slot = -1;
+
+        _hash_index.insert(id, _vec_items.size());
+        _vec_items.push_back(item);
+        if (!_bulk) bin(_vec_items.size() - 1);
+        return;
+    }
+
+    const int idx = it.value();
+    Item &item = _vec_items[idx];
+    item.x = pt.x();
+    item.y = pt.y();
+    if (_bulk) return;
+
+    if (cell_of(item.x, item.y) == item.cell) return;
+
+    unbin(idx);
+    bin(idx);
+}
+
+/**
+ * @brief TargetGrid::remove
+ * the last item takes the place of the removed one
+ */
+void TargetGrid::remove(int id)
+{
+    auto it = _hash_index.find(id);
+    if (it == _hash_index.end()) return;
+
+    const int idx = it.value();
+    _hash_index.erase(it);
+    if (!_bulk) unbin(idx);
+
+    const int last = _vec_items.size() - 1;
+    if (idx != last)
+    {
+        _vec_items[idx] = _vec_items.at(last);
+
+        const Item &moved = _vec_items.at(idx);
+        _hash_index[moved.id] = idx;
+        if (!_bulk) _vec_cells[moved.cell][moved.slot] = idx;
+    }
+    _vec_items.resize(last);
+}
+
+void TargetGrid::clear()
+{
+    _vec_items.resize(0);
+    _hash_index.clear();
+
+    for (auto &cell : _vec_cells)
+    {
+        cell.resize(0);
+    }
+}
+
+int TargetGrid::size() const
+{
+    return _vec_items.size();
+}
+
+void TargetGrid::begin_bulk()
+{
+    _bulk = true;
+}
+
+void TargetGrid::end_bulk()
+{
+    if (!_bulk) return;
+
+    _bulk = false;
+    rebin_all();
+}
+
+/**
+ * @brief TargetGrid::pick
+ * only the cells under the square around pt are searched
+ */
+int TargetGrid::pick(const QPointF &pt, double radius) const
+{
+    if (_vec_items.isEmpty()) return -1;
+
+    const int c0 = cell_col(pt.x() - radius);
+    const int c1 = cell_col(pt.x() + radius);
+    const int r0 = cell_row(pt.y() - radius);
+    const int r1 = cell_row(pt.y() + radius);
+
+    int id = -1;
+    double best = radius * radius;
+    for (int r = r0; r <= r1; ++r)
+    {
+        for (int c = c0; c <= c1; ++c)
+        {
+            for (int idx : _vec_cells.at(r * _cols + c))
+            {
+                const Item &item = _vec_items.at(idx);
+                const double dx = item.x - pt.x();
+                const double dy = item.y - pt.y();
+                const double d2 = dx * dx + dy * dy;
+                if (d2 > best || (d2 == best && id >= 0)) continue;
+
+                best = d2;
+                id = item.id;
+            }
+        }
+    }
+
+    return id;
+}
+
+int TargetGrid::cell_of(double x, double y) const
+{
+    return cell_row(y) * _cols + cell_col(x);
+}
+
+int TargetGrid::cell_col(double x) const
+{
+    const double c = std::floor((x - _rc_bounds.x()) / _cell_size);
+    return static_cast<int>(qBound(0.0, c, static_cast<double>(_cols - 1)));
+}
+
+int TargetGrid::cell_row(double y) const
+{
+    const double r = std::floor((y - _rc_bounds.y()) / _cell_size);
+    return static_cast<int>(qBound(0.0, r, static_cast<double>(_rows - 1)));
+}
+
+void TargetGrid::bin(int idx)
+{
+    Item &item = _vec_items[idx];
+    item.cell = cell_of(item.x, item.y);
+
+    QVector<int> &cell = _vec_cells[item.cell];
+    item.slot = cell.size();
+    cell.push_back(idx);
+}
+
+/**
+ * @brief TargetGrid::unbin
+ * the last index of the cell takes the slot of the removed one
+ */
+void TargetGrid::unbin(int idx)
+{
+    const Item &item = _vec_items.at(idx);
+    QVector<int> &cell = _vec_cells[item.cell];
+
+    const int lastIdx = cell.last();
+    cell[item.slot] = lastIdx;
+    _vec_items[lastIdx].slot = item.slot;
+    cell.removeLast();
+}
+
+void TargetGrid::rebin_all()
+{
+    for (auto &cell : _vec_cells)
+    {
+        cell.resize(0);
+    }
+
+    for (int i = 0; i < _vec_items.size(); ++i)
+    {
+        bin(i);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TARGET_GRID_H
+#define TARGET_GRID_H
+
+#include <QVector>
+#include <QHash>
+#include <QRectF>
+#include <QPointF>
+
+
+/**
+ * @brief The TargetGrid class
+ * uniform grid of square cells over the screen positions of the fleet markers, for hover and click picking,
+ * a moved marker changes cells only when it crosses a cell border,
+ * between `begin_bulk` and `end_bulk` only the positions are written, all markers are binned again in one pass,
+ * positions outside the bounds are kept in the border cells
+ */
+class TargetGrid
+{
+public:
+    TargetGrid();
+
+    // the markers are binned again
+    void set_bounds(const QRectF &rc, double cellSize);
+    const QRectF &bounds() const;
+
+    void update(int id, const QPointF &pt);
+    void remove(int id);
+    void clear();
+    int size() const;
+
+    // a whole fleet moves, as on zoom
+    void begin_bulk();
+    void end_bulk();
+
+    // the id of the nearest marker within `radius` of pt, -1 if none
+    int pick(const QPointF &pt, double radius) const;
+
+private:
+    int cell_of(double x, double y) const;
+    int cell_col(double x) const;
+    int cell_row(double y) const;
+
+    void bin(int idx);
+    void unbin(int idx);
+    void rebin_all();
+
+private:
+    struct Item
+    {
+        int     id;
+        double  x;
+        double  y;
+        int     cell;
+        int     slot;   // index in the cell
+    };
+
+private:
+    QRectF      _rc_bounds;
+    double      _cell_size;
+    int         _cols;
+    int         _rows;
+
+    bool        _bulk;
+
+    QVector<Item>           _vec_items;
+    QHash<int, int>         _hash_index;    // id -> index in `_vec_items`
+
+    // item indices of every cell, the storage is kept when the grid is binned again
+    QVector<QVector<int>>   _vec_cells;
+
+};
+
+#endif // TARGET_GRID_H
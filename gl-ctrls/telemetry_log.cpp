@@ -0,0 +1,368 @@
+#include "telemetry_log.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+#include <cstring>
+
+
+static const char log_magic[4] = { 'P', 'L', 'T', 'R' };
+static const quint32 log_version = 1;
+static const int log_header_size = 8;
+
+static const quint8 record_idsn = 1;
+static const quint8 record_message = 2;
+
+// type, id, len
+static const int idsn_record_size = 1 + 2 + 2;
+// type, id, time, len
+static const int message_record_size = 1 + 2 + 8 + 4;
+
+// flush to the file once the buffer grows beyond, or with the first message that long after the last flush
+static const int flush_size = 64 * 1024;
+static const qint64 flush_interval_us = 1000 * 1000;
+
+
+template <typename T>
+static inline void append_le(QByteArray &buf, T val)
+{
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        bytes[i] = static_cast<char>((static_cast<quint64>(val) >> (8 * i)) & 0xff);
+    }
+
+    buf.append(bytes, sizeof(T));
+}
+
+template <typename T>
+static inline T read_le(const uchar *p)
+{
+    quint64 val = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        val |= static_cast<quint64>(p[i]) << (8 * i);
+    }
+
+    return static_cast<T>(val);
+}
+
+
+TelemetryRecorder *TelemetryRecorder::instance()
+{
+    static TelemetryRecorder recorder;
+    return &recorder;
+}
+
+TelemetryRecorder::TelemetryRecorder()
+    : _recording(false), _flushed_us(0)
+{
+}
+
+/**
+ * @brief TelemetryRecorder::~TelemetryRecorder
+ * the process exits while recording, the buffered messages are the last seconds before it
+ */
+TelemetryRecorder::~TelemetryRecorder()
+{
+    stop();
+}
+
+/**
+ * @brief TelemetryRecorder::start
+ * truncate the file and start recording, a running recording is stopped first
+ */
+bool TelemetryRecorder::start(const QString &path)
+{
+    stop();
+
+    QMutexLocker locker(&_mtx);
+
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    _hash_idsn_ids.clear();
+    _buf.clear();
+    _buf.reserve(flush_size * 2);
+
+    _buf.append(log_magic, sizeof(log_magic));
+    append_le<quint32>(_buf, log_version);
+
+    _clock.start();
+    _flushed_us = 0;
+    _recording.store(true, std::memory_order_release);
+
+    return true;
+}
+
+void TelemetryRecorder::stop()
+{
+    QMutexLocker locker(&_mtx);
+    if (!_recording.load(std::memory_order_acquire)) return;
+
+    _recording.store(false, std::memory_order_release);
+
+    flush();
+    _file.close();
+}
+
+bool TelemetryRecorder::is_recording() const
+{
+    return _recording.load(std::memory_order_acquire);
+}
+
+void TelemetryRecorder::record(const QString &idsn, const QByteArray &msg)
+{
+    if (!is_recording()) return;
+
+    QMutexLocker locker(&_mtx);
+    if (!_recording.load(std::memory_order_relaxed)) return;
+
+    const qint64 timeUs = _clock.nsecsElapsed() / 1000;
+
+    // first message of the card, write its idsn once
+    auto it = _hash_idsn_ids.find(idsn);
+    if (it == _hash_idsn_ids.end())
+    {
+        const auto id = static_cast<quint16>(_hash_idsn_ids.size());
+        const auto utf8 = idsn.toUtf8().left(0xffff);
+
+        _buf.append(static_cast<char>(record_idsn));
+        append_le<quint16>(_buf, id);
+        append_le<quint16>(_buf, static_cast<quint16>(utf8.size()));
+        _buf.append(utf8);
+
+        it = _hash_idsn_ids.insert(idsn, id);
+    }
+
+    _buf.append(static_cast<char>(record_message));
+    append_le<quint16>(_buf, it.value());
+    append_le<quint64>(_buf, static_cast<quint64>(timeUs));
+    append_le<quint32>(_buf, static_cast<quint32>(msg.size()));
+    _buf.append(msg);
+
+    if (_buf.size() >= flush_size || timeUs - _flushed_us >= flush_interval_us)
+    {
+        flush();
+        _flushed_us = timeUs;
+    }
+}
+
+/**
+ * @brief TelemetryRecorder::flush
+ * through the buffer of the file as well, called with the mutex held
+ */
+void TelemetryRecorder::flush()
+{
+    _file.write(_buf);
+    _file.flush();
+    _buf.clear();
+}
+
+
+TelemetryReplayer::TelemetryReplayer()
+    : _data(nullptr), _size(0), _pos(0), _clock_offset_us(0), _speed(1), _has_pending(false)
+{
+    _tm_play.setTimerType(Qt::PreciseTimer);
+    _tm_play.setSingleShot(true);
+    QObject::connect(&_tm_play, &QTimer::timeout, [this]()
+    {
+        play_due();
+    });
+}
+
+TelemetryReplayer::~TelemetryReplayer()
+{
+    close();
+}
+
+/**
+ * @brief TelemetryReplayer::open
+ * map the whole log, the messages are never copied out of the mapping
+ */
+bool TelemetryReplayer::open(const QString &path)
+{
+    close();
+
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadOnly)) return false;
+
+    _size = _file.size();
+    _data = (_size >= log_header_size ? _file.map(0, _size) : nullptr);
+    if (!_data
+            || memcmp(_data, log_magic, sizeof(log_magic)) != 0
+            || read_le<quint32>(_data + sizeof(log_magic)) != log_version)
+    {
+        close();
+        return false;
+    }
+
+    _pos = log_header_size;
+    return true;
+}
+
+void TelemetryReplayer::close()
+{
+    stop();
+
+    if (_data) _file.unmap(const_cast<uchar *>(_data));
+    _file.close();
+
+    _data = nullptr;
+    _size = 0;
+    _pos = 0;
+    _hash_id_idsns.clear();
+    _has_pending = false;
+}
+
+void TelemetryReplayer::set_sink(const sink_func &func)
+{
+    _sink = func;
+}
+
+/**
+ * @brief TelemetryReplayer::start
+ * play from where it stopped, the gaps between the messages are divided by `speed`
+ */
+void TelemetryReplayer::start(double speed)
+{
+    if (!_data || speed <= 0) return;
+
+    _speed = speed;
+    if (!_has_pending) _has_pending = next_record(_pending);
+    if (!_has_pending) return;
+
+    // the pending message is due now
+    _clock.start();
+    _clock_offset_us = _pending.time_us;
+
+    play_due();
+}
+
+void TelemetryReplayer::stop()
+{
+    _tm_play.stop();
+}
+
+bool TelemetryReplayer::is_playing() const
+{
+    return _tm_play.isActive();
+}
+
+bool TelemetryReplayer::is_finished() const
+{
+    return (!_has_pending && _pos >= _size);
+}
+
+/**
+ * @brief TelemetryReplayer::run_fast
+ * feed every remaining message back to back, as a throughput benchmark of the whole path
+ */
+ReplayStats TelemetryReplayer::run_fast(int eventInterval)
+{
+    ReplayStats stats;
+    if (!_data) return stats;
+
+    stop();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    Record rec;
+    if (_has_pending)
+    {
+        rec = _pending;
+        _has_pending = false;
+    }
+    else if (!next_record(rec))
+    {
+        return stats;
+    }
+
+    do
+    {
+        if (_sink) _sink(rec.idsn, rec.msg);
+
+        ++stats.messages;
+        stats.bytes += rec.msg.size();
+
+        if (eventInterval > 0 && stats.messages % eventInterval == 0)
+        {
+            QCoreApplication::processEvents();
+        }
+    } while (next_record(rec));
+
+    QCoreApplication::processEvents();
+    stats.elapsed_ns = clock.nsecsElapsed();
+
+    return stats;
+}
+
+/**
+ * @brief TelemetryReplayer::next_record
+ * read records until the next message, false at the end or on a truncated record
+ */
+bool TelemetryReplayer::next_record(Record &rec)
+{
+    while (_pos < _size)
+    {
+        const uchar *p = _data + _pos;
+        const qint64 left = _size - _pos;
+
+        if (p[0] == record_idsn)
+        {
+            if (left < idsn_record_size) break;
+
+            const auto id = read_le<quint16>(p + 1);
+            const auto len = read_le<quint16>(p + 3);
+            if (left < idsn_record_size + len) break;
+
+            _hash_id_idsns.insert(id, QString::fromUtf8(reinterpret_cast<const char *>(p + idsn_record_size), len));
+            _pos += idsn_record_size + len;
+            continue;
+        }
+
+        if (p[0] == record_message)
+        {
+            if (left < message_record_size) break;
+
+            const auto id = read_le<quint16>(p + 1);
+            const auto timeUs = read_le<quint64>(p + 3);
+            const auto len = read_le<quint32>(p + 11);
+            if (left < message_record_size + static_cast<qint64>(len)) break;
+
+            rec.idsn = _hash_id_idsns.value(id);
+            rec.time_us = static_cast<qint64>(timeUs);
+            rec.msg = QByteArray::fromRawData(reinterpret_cast<const char *>(p + message_record_size), static_cast<int>(len));
+
+            _pos += message_record_size + len;
+            return true;
+        }
+
+        // unknown record, the rest can not be framed
+        break;
+    }
+
+    _pos = _size;
+    return false;
+}
+
+/**
+ * @brief TelemetryReplayer::play_due
+ * feed every message that is due, then sleep until the next one
+ */
+void TelemetryReplayer::play_due()
+{
+    const qint64 nowUs = _clock_offset_us + static_cast<qint64>(_clock.nsecsElapsed() / 1000 * _speed);
+
+    while (_has_pending && _pending.time_us <= nowUs)
+    {
+        if (_sink) _sink(_pending.idsn, _pending.msg);
+        _has_pending = next_record(_pending);
+    }
+
+    if (!_has_pending) return;
+
+    const qint64 waitMs = static_cast<qint64>((_pending.time_us - nowUs) / 1000 / _speed);
+    _tm_play.start(static_cast<int>(qMax<qint64>(waitMs, 0)));
+}
@@ -0,0 +1,136 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <functional>
+
+
+/**
+ * log format, little endian
+ * header:  "PLTR", u32 version
+ * idsn:    u8 1, u16 id, u16 len, utf-8 idsn
+ * message: u8 2, u16 id, u64 time (us since the recording started), u32 len, raw message
+ * every idsn is written once before its first message
+ */
+
+/**
+ * @brief The TelemetryRecorder class
+ * record every state message every card receives, from any thread,
+ * the buffer goes to the disk once it is full or a second after the last flush, and when the process exits,
+ * a crash loses at most the last second of messages
+ */
+class TelemetryRecorder
+{
+public:
+    static TelemetryRecorder *instance();
+
+    bool start(const QString &path);
+    void stop();
+    bool is_recording() const;
+
+    void record(const QString &idsn, const QByteArray &msg);
+
+private:
+    TelemetryRecorder();
+    ~TelemetryRecorder();
+
+    void flush();
+
+private:
+    std::atomic<bool>   _recording;
+
+    QMutex              _mtx;
+    QFile               _file;
+    QElapsedTimer       _clock;
+    QByteArray          _buf;
+    qint64              _flushed_us;
+
+    QHash<QString, quint16>     _hash_idsn_ids;
+
+};
+
+/**
+ * @brief The ReplayStats struct
+ * of `TelemetryReplayer::run_fast`
+ */
+struct ReplayStats
+{
+    qint64  messages;
+    qint64  bytes;
+    qint64  elapsed_ns;
+
+    ReplayStats()
+        : messages(0), bytes(0), elapsed_ns(0)
+    {}
+};
+
+/**
+ * @brief The TelemetryReplayer class
+ * memory map a log and feed its messages to the sink again,
+ * in real time, n times faster, or as fast as possible,
+ * the message handed to the sink points into the mapped file, copy it to keep it
+ */
+class TelemetryReplayer
+{
+public:
+    typedef std::function<void (const QString &, const QByteArray &)>   sink_func;
+
+public:
+    TelemetryReplayer();
+    ~TelemetryReplayer();
+
+    bool open(const QString &path);
+    void close();
+
+    // `PreciseLandingAssistCard::replay_sink` feeds the messages to the cards
+    void set_sink(const sink_func &func);
+
+    // speed: 1 is real time, 2 twice as fast, in the gui thread
+    void start(double speed = 1);
+    void stop();
+    bool is_playing() const;
+    bool is_finished() const;
+
+    // as fast as possible, `processEvents` is called every `eventInterval` messages so that the cards render
+    ReplayStats run_fast(int eventInterval = 100);
+
+private:
+    struct Record
+    {
+        QString     idsn;
+        qint64      time_us;
+        QByteArray  msg;
+    };
+
+private:
+    bool next_record(Record &rec);
+    void play_due();
+
+private:
+    QFile           _file;
+    const uchar     *_data;
+    qint64          _size;
+    qint64          _pos;
+
+    QHash<quint16, QString>     _hash_id_idsns;
+
+    sink_func       _sink;
+
+    // real time playing
+    QTimer          _tm_play;
+    QElapsedTimer   _clock;
+    qint64          _clock_offset_us;
+    double          _speed;
+    bool            _has_pending;
+    Record          _pending;
+
+};
+
+#endif // TELEMETRY_LOG_H
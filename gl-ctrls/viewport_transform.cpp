@@ -0,0 +1,96 @@
+#include "viewport_transform.h"
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(QT_COORD_TYPE)
+#define VIEWPORT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// the spans are read and written as packed floats and doubles, QPointF is standard layout, `rx` is not const
+static_assert(sizeof(GLPoint2f) == 2 * sizeof(float), "GLPoint2f must be two packed floats");
+static_assert(sizeof(QPointF) == 2 * sizeof(qreal), "QPointF must be two packed qreals");
+
+
+ViewportTransform::ViewportTransform(const QRect &rcViewPort)
+{
+    set_viewport(rcViewPort);
+}
+
+void ViewportTransform::set_viewport(const QRect &rcViewPort)
+{
+    _rc_viewport = rcViewPort;
+
+    // the center between the pixels, as `GLFuncUtils::rect_center`
+    _offset_x = (rcViewPort.left() + rcViewPort.right() + 1) / 2.0;
+    _offset_y = (rcViewPort.top() + rcViewPort.bottom() + 1) / 2.0;
+
+    // gl y points up, pixel y down
+    _scale_x = rcViewPort.width() / 2.0;
+    _scale_y = -rcViewPort.height() / 2.0;
+
+    _inv_scale_x = (rcViewPort.width() > 0 ? 1 / _scale_x : 0);
+    _inv_scale_y = (rcViewPort.height() > 0 ? 1 / _scale_y : 0);
+}
+
+const QRect &ViewportTransform::viewport() const
+{
+    return _rc_viewport;
+}
+
+/**
+ * @brief ViewportTransform::to_pixels
+ * the same results as `to_pixel` point by point, two points per step, the odd last one by `to_pixel`
+ */
+void ViewportTransform::to_pixels(const GLPoint2f *src, QPointF *dst, int count) const
+{
+    int i = 0;
+
+#ifdef VIEWPORT_USE_SSE2
+    const __m128d offset = _mm_set_pd(_offset_y, _offset_x);
+    const __m128d scale = _mm_set_pd(_scale_y, _scale_x);
+    qreal *dstWords = reinterpret_cast<qreal *>(dst);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        // x0 y0 x1 y1
+        const __m128 f = _mm_loadu_ps(&src[i].x);
+        const __m128d d0 = _mm_add_pd(offset, _mm_mul_pd(_mm_cvtps_pd(f), scale));
+        const __m128d d1 = _mm_add_pd(offset, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(f, f)), scale));
+        _mm_storeu_pd(dstWords + 2*i, d0);
+        _mm_storeu_pd(dstWords + 2*i + 2, d1);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        dst[i] = to_pixel(src[i]);
+    }
+}
+
+/**
+ * @brief ViewportTransform::to_gl
+ * the same results as the single point `to_gl` point by point, two points per step, the odd last one by `to_gl`
+ */
+void ViewportTransform::to_gl(const QPointF *src, GLPoint2f *dst, int count) const
+{
+    int i = 0;
+
+#ifdef VIEWPORT_USE_SSE2
+    const __m128d offset = _mm_set_pd(_offset_y, _offset_x);
+    const __m128d invScale = _mm_set_pd(_inv_scale_y, _inv_scale_x);
+    const qreal *srcWords = reinterpret_cast<const qreal *>(src);
+
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128d d0 = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(srcWords + 2*i), offset), invScale);
+        const __m128d d1 = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(srcWords + 2*i + 2), offset), invScale);
+
+        // x0 y0 x1 y1
+        _mm_storeu_ps(&dst[i].x, _mm_movelh_ps(_mm_cvtpd_ps(d0), _mm_cvtpd_ps(d1)));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        dst[i] = to_gl(src[i]);
+    }
+}
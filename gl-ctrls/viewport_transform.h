@@ -0,0 +1,54 @@
+#ifndef VIEWPORT_TRANSFORM_H
+#define VIEWPORT_TRANSFORM_H
+
+#include <QPointF>
+#include <QRect>
+
+#include "gl_utils.h"
+
+
+/**
+ * @brief The ViewportTransform class
+ * gl coordinates of a viewport to its pixels and back, the center and the scales are computed once per viewport,
+ * pixel = center + gl * (w/2, -h/2), the spans are converted two points at a time with sse2
+ */
+class ViewportTransform
+{
+public:
+    ViewportTransform(const QRect &rcViewPort = QRect());
+
+    void set_viewport(const QRect &rcViewPort);
+    const QRect &viewport() const;
+
+    QPointF to_pixel(const GLPoint2f &pt) const;
+    GLPoint2f to_gl(const QPointF &pt) const;
+
+    // src and dst may not overlap
+    void to_pixels(const GLPoint2f *src, QPointF *dst, int count) const;
+    void to_gl(const QPointF *src, GLPoint2f *dst, int count) const;
+
+private:
+    QRect       _rc_viewport;
+
+    // pixel = _offset + gl * _scale, gl = (pixel - _offset) * _inv_scale
+    double      _offset_x;
+    double      _offset_y;
+    double      _scale_x;
+    double      _scale_y;
+    double      _inv_scale_x;
+    double      _inv_scale_y;
+
+};
+
+inline QPointF ViewportTransform::to_pixel(const GLPoint2f &pt) const
+{
+    return QPointF(_offset_x + pt.x * _scale_x, _offset_y + pt.y * _scale_y);
+}
+
+inline GLPoint2f ViewportTransform::to_gl(const QPointF &pt) const
+{
+    return GLPoint2f(static_cast<float>((pt.x() - _offset_x) * _inv_scale_x),
+                     static_cast<float>((pt.y() - _offset_y) * _inv_scale_y));
+}
+
+#endif // VIEWPORT_TRANSFORM_H
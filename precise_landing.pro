@@ -7,13 +7,51 @@ LIBS += \
 
 HEADERS +=  \
     gl-ctrls/gl_utils.h     \
-    gl-ctrls/precise_landing_assist_ctrl.h
+    gl-ctrls/gl_glyph_atlas.h   \
+    gl-ctrls/viewport_transform.h   \
+    gl-ctrls/target_grid.h      \
+    gl-ctrls/rim_clusters.h     \
+    gl-ctrls/spsc_queue.h       \
+    gl-ctrls/frame_packet.h     \
+    gl-ctrls/frame_pipeline.h   \
+    gl-ctrls/seq_lock.h     \
+    gl-ctrls/json_selective_extractor.h     \
+    gl-ctrls/geodesy.h      \
+    gl-ctrls/precise_landing_state.h    \
+    gl-ctrls/dead_reckoning.h   \
+    gl-ctrls/approach_trail.h   \
+    gl-ctrls/render_backend.h   \
+    gl-ctrls/gl_render_backend.h    \
+    gl-ctrls/raster_render_backend.h    \
+    gl-ctrls/frame_profiler.h   \
+    gl-ctrls/record_render_backend.h    \
+    gl-ctrls/render_scheduler.h     \
+    gl-ctrls/telemetry_log.h    \
+    gl-ctrls/precise_landing_assist_ctrl.h  \
+    gl-ctrls/precise_landing_assist_host.h
 #    gl-ctrls/precise_landing_assist_card.h
 
 
 SOURCES +=  \
     gl-ctrls/gl_utils.cpp     \
+    gl-ctrls/gl_glyph_atlas.cpp     \
+    gl-ctrls/viewport_transform.cpp     \
+    gl-ctrls/target_grid.cpp    \
+    gl-ctrls/rim_clusters.cpp   \
+    gl-ctrls/frame_packet.cpp   \
+    gl-ctrls/frame_pipeline.cpp \
+    gl-ctrls/json_selective_extractor.cpp   \
+    gl-ctrls/geodesy.cpp    \
+    gl-ctrls/dead_reckoning.cpp     \
+    gl-ctrls/approach_trail.cpp     \
+    gl-ctrls/gl_render_backend.cpp  \
+    gl-ctrls/raster_render_backend.cpp  \
+    gl-ctrls/frame_profiler.cpp     \
+    gl-ctrls/record_render_backend.cpp  \
+    gl-ctrls/render_scheduler.cpp   \
+    gl-ctrls/telemetry_log.cpp  \
     gl-ctrls/precise_landing_assist_ctrl.cpp    \
+    gl-ctrls/precise_landing_assist_host.cpp    \
 #    gl-ctrls/precise_landing_assist_card.cpp
     main.cpp
 
@@ -0,0 +1,57 @@
+# linux with glibc (the allocations are counted through malloc) and mesa (llvmpipe under xvfb),
+# qt 5 built for desktop opengl, not opengl es, for the 4.5 compatibility functions
+QT += widgets core opengl
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = precise_landing_bench
+
+LIBS += \
+
+
+HEADERS +=  \
+    gl-ctrls/gl_utils.h     \
+    gl-ctrls/gl_glyph_atlas.h   \
+    gl-ctrls/viewport_transform.h   \
+    gl-ctrls/target_grid.h      \
+    gl-ctrls/rim_clusters.h     \
+    gl-ctrls/spsc_queue.h       \
+    gl-ctrls/frame_packet.h     \
+    gl-ctrls/frame_pipeline.h   \
+    gl-ctrls/seq_lock.h     \
+    gl-ctrls/json_selective_extractor.h     \
+    gl-ctrls/geodesy.h      \
+    gl-ctrls/precise_landing_state.h    \
+    gl-ctrls/dead_reckoning.h   \
+    gl-ctrls/approach_trail.h   \
+    gl-ctrls/render_backend.h   \
+    gl-ctrls/gl_render_backend.h    \
+    gl-ctrls/raster_render_backend.h    \
+    gl-ctrls/frame_profiler.h   \
+    gl-ctrls/record_render_backend.h    \
+    gl-ctrls/render_scheduler.h     \
+    gl-ctrls/precise_landing_assist_ctrl.h  \
+    gl-ctrls/precise_landing_assist_host.h
+
+
+SOURCES +=  \
+    gl-ctrls/gl_utils.cpp     \
+    gl-ctrls/gl_glyph_atlas.cpp     \
+    gl-ctrls/viewport_transform.cpp     \
+    gl-ctrls/target_grid.cpp    \
+    gl-ctrls/rim_clusters.cpp   \
+    gl-ctrls/frame_packet.cpp   \
+    gl-ctrls/frame_pipeline.cpp \
+    gl-ctrls/json_selective_extractor.cpp   \
+    gl-ctrls/geodesy.cpp    \
+    gl-ctrls/dead_reckoning.cpp     \
+    gl-ctrls/approach_trail.cpp     \
+    gl-ctrls/gl_render_backend.cpp  \
+    gl-ctrls/raster_render_backend.cpp  \
+    gl-ctrls/frame_profiler.cpp     \
+    gl-ctrls/record_render_backend.cpp  \
+    gl-ctrls/render_scheduler.cpp   \
+    gl-ctrls/precise_landing_assist_ctrl.cpp    \
+    gl-ctrls/precise_landing_assist_host.cpp    \
+    bench/bench_main.cpp